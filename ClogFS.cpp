@@ -1,27 +1,63 @@
 #include "ClogFS.h"
+#include "ClogJson.h"
 #include <time.h>
 #include <cstdarg>
 #include <cstdio>
 #include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <unistd.h>
+#if defined(ARDUINO_ARCH_ESP32)
+  #include <esp_rom_crc.h>
+#endif
+
+static const uint32_t MANIFEST_MAGIC = 0x314D4C43; // "CLM1"
 
 ClogFS::ClogFS()
-: _file(), _fileOk(false), _fileReady(false),
+: _chan(), _sink(), _nChan(1), _budget(0), _retainT0(0),
   _nowFn(nullptr),
   _bootBuf(), _bootCap(4096),
   _lastDay(-1),
   _fsLowWater(2048),
-  _basePath("/"),
-  _currentPath(""),
-  _minSev(INFO),
-  _level(LVL_SERIAL_AND_LOG)   // default: Serial + FS
-{}
+  _basePath("/"), _mountPoint("/littlefs"),
+  _level(LVL_SERIAL_AND_LOG),  // default: Serial + FS
+  _serialFmt(FMT_TEXT), _fileFmt(FMT_TEXT), _nameFn(nullptr),
+  _framing(true),
+  _segs(), _manifestOk(false),
+  _sites(), _nSites(0), _sampleSummaryMs(60000), _sampleSummaryT0(0),
+  _shedPct{50, 70, 85}, _critFlush(true),
+  _shed(), _shedPeriod(), _shedSummaryMs(60000), _shedSummaryT0(0),
+  _wrWinT0(0), _wrBusyUs(0), _wrBusyPct(0),
+  _recent(), _recentBase(0),
+  _stage(), _drainBuf(nullptr),
+  _stageBlock(4096), _stageHigh(0), _stageLow(0), _stagePeak(0),
+  _stagePsram(false), _inDrain(false),
+  _stageStalls(0), _stageDropped(0),
+  _stageIn(0), _stageOut(0),
+  _stageT0(0), _rateWinT0(0), _rateWinBytes(0), _ratePeak(0)
+#if defined(ARDUINO_ARCH_ESP32)
+  , _stageMux(portMUX_INITIALIZER_UNLOCKED),
+  _fileMux(nullptr), _stageTaskH(nullptr), _drainOwner(nullptr)
+#endif
+{
+  strcpy(_chan[0].name, "log");
+  _chan[0].minSev = INFO;
+  for (Sink& s : _sink) s.seg = -1;
+}
 
 
 // config
 void ClogFS::setTimeProvider(time_t (*nowFn)()){ _nowFn = nowFn; }
-void ClogFS::setBootBufferCapacityBytes(size_t cap){ _bootCap = cap ? cap : 1024; }
+void ClogFS::setBootBufferCapacityBytes(size_t cap){
+  _bootCap = cap ? cap : 1024;
+  if (_bootCap > CLOGFS_FRAME_MAX - 512) _bootCap = CLOGFS_FRAME_MAX - 512;   // entra en un bloque
+}
 void ClogFS::setFsLowWater(size_t bytes){ _fsLowWater = bytes; }
 void ClogFS::setBasePath(const char* p){ _basePath = (p && *p) ? String(p) : String("/"); }
+void ClogFS::setMountPoint(const char* vfs){
+  _mountPoint = vfs ? String(vfs) : String();
+  if (_mountPoint.endsWith("/")) _mountPoint.remove(_mountPoint.length() - 1);
+}
 
 // severidad helpers
 const char* ClogFS::sevName(Severity s){
@@ -35,27 +71,30 @@ const char* ClogFS::sevName(Severity s){
   }
   return "?";
 }
-void ClogFS::setMinSeverity(Severity s){ _minSev = s; }
+void ClogFS::setMinSeverity(Severity s){ _chan[0].minSev = s; }
+
+bool ClogFS::sevFromName(const char* name, Severity* out){
+  if (!name) return false;
+  for (int s = TRACE; s <= CRIT; ++s) {
+    if (strcasecmp(name, sevName((Severity)s)) == 0) { *out = (Severity)s; return true; }
+  }
+  return false;
+}
 
 // open/rotate/close
 bool ClogFS::openFile(const char* filename, const char* header_ascii){
-  if (_file) { _file.flush(); _file.close(); }
+  lockFile();
+  flushStaging();
 
   String full = (filename && filename[0] == '/') ? String(filename)
                                                  : (String("/") + filename);
   if (full[0] != '/') full = String("/") + full;
 
-  _file = LittleFS.open(full.c_str(), FILE_WRITE);
-  _fileOk = _file && _file.print("") >= 0;
-  _fileReady = _fileOk;
-  if (_fileOk) _currentPath = full;
-
-  if (_fileOk && header_ascii && *header_ascii) {
-    _file.println(header_ascii);
-    _file.flush();
-  }
-  if (_fileOk) {
+  bool ok = openSink(0, full, header_ascii);
+  if (ok) {
     flushBootBufferToFile();
+    frameClose(_sink[0]);
+    enforceRetention();        // el anterior quedó cerrado: ya cuenta
   }
 
   if (_nowFn) {
@@ -65,32 +104,28 @@ bool ClogFS::openFile(const char* filename, const char* header_ascii){
       if (tm_info) _lastDay = tm_info->tm_mday;
     }
   }
-  return _fileOk;
+  unlockFile();
+  return ok;
 }
 
 bool ClogFS::rotate(const String& newFilename, const char* header_ascii){
-  if (_file) { _file.flush(); _file.close(); }
-  _fileReady = false;
+  lockFile();
+  flushStaging();
+  for (uint8_t c = 1; c < _nChan; ++c) closeSink(_sink[c]);   // se reabren con fecha nueva
 
   String full = newFilename.startsWith("/") ? newFilename : (String("/") + newFilename);
-  _file = LittleFS.open(full.c_str(), FILE_WRITE);
-  _fileOk = _file && _file.print("") >= 0;
-  _fileReady = _fileOk;
-  if (_fileOk) _currentPath = full;
+  bool ok = openSink(0, full, header_ascii);
+  if (ok) enforceRetention();
 
-  if (_fileOk && header_ascii && *header_ascii) {
-    _file.println(header_ascii);
-    _file.flush();
-  }
-
-  if (_fileOk && _nowFn) {
+  if (ok && _nowFn) {
     time_t t = _nowFn();
     if (t > 0) {
       struct tm* tm_info = localtime(&t);
       if (tm_info) _lastDay = tm_info->tm_mday;
     }
   }
-  return _fileOk;
+  unlockFile();
+  return ok;
 }
 
 bool ClogFS::rotateDailyIfNeeded(const char* header_ascii){
@@ -104,44 +139,112 @@ bool ClogFS::rotateDailyIfNeeded(const char* header_ascii){
   if (_lastDay == -1) { _lastDay = today; return false; }
   if (today == _lastDay) return false;
 
-  String newName = ClogFS::makeFilename(now);
+  String newName = ClogFS::makeFilename(now, fileExt());
   bool ok = rotate(newName, header_ascii);
   if (ok) _lastDay = today;
   return ok;
 }
 
 void ClogFS::closeFile(){
-  if (_file) { _file.flush(); _file.close(); }
-  _fileOk = false;
-  _fileReady = false;
+  lockFile();
+  flushStaging();
+  for (uint8_t c = 0; c < _nChan; ++c) closeSink(_sink[c]);
+  if (_manifestOk) saveManifest();
+  unlockFile();
+}
+
+bool ClogFS::isOpenFile(const char* name) const {
+  for (uint8_t c = 0; c < _nChan; ++c) {
+    const Sink& s = _sink[c];
+    if (s.ok && strcmp(s.path.c_str() + s.path.lastIndexOf('/') + 1, name) == 0) return true;
+  }
+  return false;
+}
+
+// cierra el anterior (trailer del bloque abierto) y abre fullPath en cero
+bool ClogFS::openSink(uint8_t ch, const String& fullPath, const char* header_ascii){
+  Sink& s = _sink[ch];
+  closeSink(s);
+  s.file  = LittleFS.open(fullPath.c_str(), FILE_WRITE);
+  s.ok    = s.file && s.file.print("") >= 0;
+  s.ready = s.ok;
+  s.frameSeq = s.frameLen = s.frameCrc = 0;
+  if (s.ok) { s.path = fullPath; s.fmt = _fileFmt; segOpened(s, fullPath); }
+  if (s.ok) writeHeader(s, header_ascii);
+  return s.ok;
+}
+
+void ClogFS::closeSink(Sink& s){
+  if (s.file) { frameClose(s); s.file.flush(); s.file.close(); }
+  s.ok = s.ready = false;
+  s.seg = -1;
+}
+
+// archivo del canal para la próxima escritura. Los canales != 0 abren
+// al primer uso y rotan por tamaño; el nombre nunca pisa uno existente
+// (dos rotaciones en el mismo segundo).
+ClogFS::Sink* ClogFS::sinkFor(uint8_t ch){
+  Sink& s = _sink[ch];
+  if (ch && s.ok && _chan[ch].maxFile && s.seg >= 0 && _segs[s.seg].size >= _chan[ch].maxFile)
+    closeSink(s);
+  if (ch && !s.ok && _sink[0].ok) {
+    time_t now = _nowFn ? _nowFn() : time(nullptr);
+    if (now <= 0) now = time(nullptr);
+    String name = makeFilename(now, fileExt(), _chan[ch].name);
+    while (name.length() && (segIndex(name.c_str()) >= 0 || LittleFS.exists(fullPathOf(name.c_str()))))
+      name = makeFilename(++now, fileExt(), _chan[ch].name);
+    if (name.length() && openSink(ch, fullPathOf(name.c_str()), nullptr)) enforceRetention();
+  }
+  return s.ok ? &s : nullptr;
 }
 
 // API de log (msg == info)
 void ClogFS::msg(const __FlashStringHelper *fmt, ...){
-  va_list ap; va_start(ap, fmt); vmsg_(INFO, fmt, ap); va_end(ap);
+  va_list ap; va_start(ap, fmt); vmsg_(0, INFO, fmt, ap); va_end(ap);
 }
 void ClogFS::trace(const __FlashStringHelper *fmt, ...){
-  va_list ap; va_start(ap, fmt); vmsg_(TRACE, fmt, ap); va_end(ap);
+  va_list ap; va_start(ap, fmt); vmsg_(0, TRACE, fmt, ap); va_end(ap);
 }
 void ClogFS::debug(const __FlashStringHelper *fmt, ...){
-  va_list ap; va_start(ap, fmt); vmsg_(DEBUG, fmt, ap); va_end(ap);
+  va_list ap; va_start(ap, fmt); vmsg_(0, DEBUG, fmt, ap); va_end(ap);
 }
 void ClogFS::info(const __FlashStringHelper *fmt, ...){
-  va_list ap; va_start(ap, fmt); vmsg_(INFO, fmt, ap); va_end(ap);
+  va_list ap; va_start(ap, fmt); vmsg_(0, INFO, fmt, ap); va_end(ap);
 }
 void ClogFS::warn(const __FlashStringHelper *fmt, ...){
-  va_list ap; va_start(ap, fmt); vmsg_(WARN, fmt, ap); va_end(ap);
+  va_list ap; va_start(ap, fmt); vmsg_(0, WARN, fmt, ap); va_end(ap);
 }
 void ClogFS::error(const __FlashStringHelper *fmt, ...){
-  va_list ap; va_start(ap, fmt); vmsg_(ERROR, fmt, ap); va_end(ap);
+  va_list ap; va_start(ap, fmt); vmsg_(0, ERROR, fmt, ap); va_end(ap);
 }
 void ClogFS::crit(const __FlashStringHelper *fmt, ...){
-  va_list ap; va_start(ap, fmt); vmsg_(CRIT, fmt, ap); va_end(ap);
+  va_list ap; va_start(ap, fmt); vmsg_(0, CRIT, fmt, ap); va_end(ap);
+}
+void ClogFS::log(uint8_t ch, Severity sev, const __FlashStringHelper *fmt, ...){
+  va_list ap; va_start(ap, fmt); vmsg_(ch, sev, fmt, ap); va_end(ap);
+}
+// mensajes propios del logger que no pasan por el umbral (canal 0)
+void ClogFS::notice(Severity sev, const __FlashStringHelper *fmt, ...){
+  va_list ap; va_start(ap, fmt); vmsg_(0, sev, fmt, ap, true); va_end(ap);
 }
 
-void ClogFS::vmsg_(Severity sev, const __FlashStringHelper *fmt, va_list ap){
-  if (sev < _minSev) return;
+void ClogFS::vmsg_(uint8_t ch, Severity sev, const __FlashStringHelper *fmt, va_list ap, bool force){
+  if (ch >= _nChan || (sev < _chan[ch].minSev && !force)) return;
   if (_level == LVL_OFF) return;
+  if (_nSites && !sampleAdmit(fmt)) return;   // antes de formatear
+
+  bool toSerial = (_level == LVL_SERIAL || _level == LVL_SERIAL_AND_LOG);
+  bool toFs     = (_level == LVL_LOG_ONLY || _level == LVL_SERIAL_AND_LOG) && admit(sev);
+  if (!toSerial && !toFs && !_recent.capacity()) return;
+
+  // el boot buffer se guarda en el formato del archivo que lo va a recibir
+  Format fileFmt    = _sink[0].ok ? _sink[0].fmt : _fileFmt;
+  bool   jsonSerial = toSerial && _serialFmt == FMT_JSONL;
+  bool   jsonFile   = toFs && fileFmt == FMT_JSONL;
+
+  // los argumentos se leen dos veces (texto + JSON): copia antes de usarlos
+  va_list aj;
+  if (jsonSerial || jsonFile) va_copy(aj, ap);
 
   char buf[192];
   vsnprintf_P(buf, sizeof(buf), (PGM_P)fmt, ap);
@@ -150,16 +253,33 @@ void ClogFS::vmsg_(Severity sev, const __FlashStringHelper *fmt, va_list ap){
   bool have_ts = buildTimePrefix(ts, sizeof(ts));
 
   char line[224];
-  if (have_ts) snprintf(line, sizeof(line), "%s %s%s", sevName(sev), ts, buf);
-  else         snprintf(line, sizeof(line), "%s %lu %s", sevName(sev), (unsigned long)millis(), buf);
+  int pl = have_ts ? snprintf(line, sizeof(line), "%s %s", sevName(sev), ts)
+                   : snprintf(line, sizeof(line), "%s %lu ", sevName(sev), (unsigned long)millis());
+  snprintf(line + pl, sizeof(line) - pl, "%s", buf);
+
+  // fuera de su archivo (Serial, caché, boot buffer) la línea lleva el canal
+  char tagged[240];
+  const char* shown = line;
+  if (ch) {
+    snprintf(tagged, sizeof(tagged), "%.*s[%s] %s", pl, line, _chan[ch].name, line + pl);
+    shown = tagged;
+  }
+
+  recentAppend(ch, sev, shown);   // la caché reciente queda en texto
+
+  char json[384];
+  if (jsonSerial || jsonFile) {
+    buildJson(json, sizeof(json), ch, sev, fmt, aj, buf);
+    va_end(aj);
+  }
 
   // Serial?
-  if (_level == LVL_SERIAL || _level == LVL_SERIAL_AND_LOG) {
-    Serial.println(line);
+  if (toSerial) {
+    Serial.println(jsonSerial ? json : shown);
   }
   // FS?
-  if (_level == LVL_LOG_ONLY || _level == LVL_SERIAL_AND_LOG) {
-    writeLineASCII(line);
+  if (toFs) {
+    writeLine(ch, jsonFile ? json : line, sev, jsonFile ? json : shown);
   }
 }
 
@@ -169,6 +289,18 @@ void ClogFS::vmsg_(Severity sev, const __FlashStringHelper *fmt, va_list ap){
 
 void ClogFS::listDir(const char* path){
   const char* p = (path && *path) ? path : "/";
+
+  // base montada → manifest en RAM, sin recorrer el FS
+  String dirp = p;
+  if (!dirp.endsWith("/")) dirp += "/";
+  if (_manifestOk && dirp == fullPathOf("")) {
+    if (_segs.empty()) { debug(F("fs: directory empty")); return; }
+    for (size_t i = 0; i < _segs.size(); ++i) {
+      debug(F("fs: found %s (%uB)"), _segs[i].name, (unsigned)_segs[i].size);
+    }
+    return;
+  }
+
   File dir = LittleFS.open(p, FILE_READ);
   if (!dir || !dir.isDirectory()){
     // problema al abrir -> WARN
@@ -194,12 +326,17 @@ void ClogFS::listDir(const char* path){
 }
 
 
-String ClogFS::makeFilename(time_t epoch){
+// "<prefijo>-YYYYMMDD-HHMMSS<ext>": prefijo hasta un nombre de canal,
+// extensión hasta ".jsonl"; el búfer cubre el peor caso de cada campo
+String ClogFS::makeFilename(time_t epoch, const char* ext, const char* prefix){
   struct tm* tm_info = localtime(&epoch);
-  char name[32];
-  snprintf(name, sizeof(name), "log-%04d%02d%02d-%02d%02d%02d.txt",
-           tm_info->tm_year+1900, tm_info->tm_mon+1, tm_info->tm_mday,
-           tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec);
+  if (!tm_info) return String();
+  char name[sizeof(Chan::name) + 6 * 11 + 16];
+  int n = snprintf(name, sizeof(name), "%.*s-%04d%02d%02d-%02d%02d%02d%.7s",
+                   (int)sizeof(Chan::name) - 1, prefix ? prefix : "log",
+                   tm_info->tm_year+1900, tm_info->tm_mon+1, tm_info->tm_mday,
+                   tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec, ext ? ext : ".txt");
+  if (n < 0 || (size_t)n >= sizeof(name)) return String();
   return String(name);
 }
 
@@ -215,6 +352,17 @@ size_t ClogFS::fsFreeBytes() const {
 }
 
 bool ClogFS::wipeAllInBasePath(){
+  if (_manifestOk) {
+    for (size_t i = 0; i < _segs.size(); ++i) {
+      String full = fullPathOf(_segs[i].name);
+      if (!LittleFS.remove(full)) LittleFS.remove(_segs[i].name);
+    }
+    _segs.clear();
+    for (Sink& sk : _sink) sk.seg = -1;
+    saveManifest();
+    return true;
+  }
+
   File dir = LittleFS.open(_basePath.c_str(), FILE_READ);
   if (!dir || !dir.isDirectory()) return false;
 
@@ -241,46 +389,88 @@ bool ClogFS::reopenFreshFileAfterWipe(const char* header_ascii){
   closeFile();
   time_t now = _nowFn ? _nowFn() : time(nullptr);
   if (now <= 0) now = time(nullptr);
-  String newName = makeFilename(now);
+  String newName = makeFilename(now, fileExt());
   return openFile(newName.c_str(), header_ascii);
 }
 
-void ClogFS::writeLineASCII(const char* line){
+void ClogFS::writeLine(uint8_t ch, const char* line, Severity sev, const char* bootLine){
   // si no estamos en un modo que escribe a FS, salgo
   if (!(_level == LVL_LOG_ONLY || _level == LVL_SERIAL_AND_LOG)) return;
 
+  // staging: a RAM, la tarea escribe en bloques
+  if (stagingEnabled() && _sink[0].ready && _sink[0].ok && !drainingHere()) {
+    stagePush(ch, line, sev);
+    if (sev == CRIT && _critFlush) { flushStaging(); }
+    return;
+  }
+
+  uint32_t t0 = micros();      // espera del lock + escritura: carga sin staging
+  lockFile();
   size_t need = strlen(line) + 1;
 
   size_t freeB = fsFreeBytes();
-  if (freeB > 0 && freeB < (need + _fsLowWater)) {
+  if (freeB > 0 && freeB < (need + _fsLowWater) && !reclaim(need)) {
     closeFile();
     wipeAllInBasePath();
     reopenFreshFileAfterWipe("FS_WIPE=1");
   }
 
-  bool ok1 = false;
-  if (_fileReady && _fileOk) {
-    size_t n = _file.println(line);
-    ok1 = (n > 0);
-  } else {
-    bootBufAppendLine(line);
+  // sin archivo principal (boot, modo CFG): todos los canales al boot buffer
+  Sink* s = (_sink[0].ready && _sink[0].ok) ? sinkFor(ch) : nullptr;
+  if (!s) {
+    bootBufAppendLine(bootLine);
+    unlockFile();
     return;
   }
 
-  if (ok1) return;
+  bool ok1 = false;
+  frameRoom(*s, need + 1);
+  size_t n = fileWrite(*s, line, need - 1);
+  if (n) n += fileWrite(*s, "\r\n", 2);
+  ok1 = (n > 0);
+  if (ok1) segAppend(s->seg, n, sev);
+
+  if (ok1) {
+    bool crit = (sev == CRIT && _critFlush);
+    if (crit || s->frameLen >= CLOGFS_FRAME_BYTES) frameClose(*s);
+    if (crit) s->file.flush();
+    writeBusy(t0);
+    unlockFile();
+    return;
+  }
 
   // Fallback
   wipeAllInBasePath();
-  if (reopenFreshFileAfterWipe("FS_WIPE=1")) {
-    _file.println(line);
+  if (reopenFreshFileAfterWipe("FS_WIPE=1") && (s = sinkFor(ch)) != nullptr) {
+    n = fileWrite(*s, line, need - 1);
+    segAppend(s->seg, n + fileWrite(*s, "\r\n", 2), sev);
+  }
+  writeBusy(t0);
+  unlockFile();
+}
+
+// escritura directa: fracción del tiempo que el log pasó bloqueado en la
+// flash durante la última ventana (sin staging no hay buffer que mirar)
+void ClogFS::writeBusy(uint32_t t0){
+  uint32_t now = micros();
+  _wrBusyUs += now - t0;
+  uint32_t el = now - _wrWinT0;
+  if (el >= CLOGFS_BUSY_WINDOW_US) {
+    uint64_t pct = (uint64_t)_wrBusyUs * 100 / el;
+    _wrBusyPct = (uint8_t)(pct > 100 ? 100 : pct);
+    _wrBusyUs  = 0;
+    _wrWinT0   = now;
   }
 }
 
 
 void ClogFS::flushBootBufferToFile(){
-  if(!_fileOk || _bootBuf.isEmpty()) return;
-  _file.print(_bootBuf);
-  _file.flush();
+  Sink& s = _sink[0];
+  if(!s.ok || _bootBuf.isEmpty()) return;
+  frameRoom(s, _bootBuf.length());
+  fileWrite(s, _bootBuf.c_str(), _bootBuf.length());
+  s.file.flush();
+  segAppendBlock(s.seg, _bootBuf.c_str(), _bootBuf.length());
   _bootBuf = "";
 }
 
@@ -318,3 +508,1167 @@ void ClogFS::resetDayTracking(){ _lastDay = -1; }
 
 
 
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// manifest
+// ─────────────────────────────────────────────────────────────────────────────
+String ClogFS::fullPathOf(const char* name) const {
+  String base = _basePath;
+  if (!base.startsWith("/")) base = String("/") + base;
+  if (!base.endsWith("/"))   base += "/";
+  return base + name;
+}
+
+int ClogFS::segIndex(const char* name) const {
+  for (size_t i = 0; i < _segs.size(); ++i) {
+    if (strcmp(_segs[i].name, name) == 0) return (int)i;
+  }
+  return -1;
+}
+
+const ClogFS::Segment* ClogFS::findSegment(const char* name) const {
+  int i = segIndex(name);
+  return (i >= 0) ? &_segs[i] : nullptr;
+}
+
+// archivo recién abierto con FILE_WRITE → entrada en cero
+void ClogFS::segOpened(Sink& s, const String& fullPath){
+  if (!_manifestOk) return;
+  String name = fullPath.substring(fullPath.lastIndexOf('/') + 1);
+  int i = segIndex(name.c_str());
+  if (i < 0) {
+    _segs.push_back(Segment());
+    i = (int)_segs.size() - 1;
+  }
+  Segment& sg = _segs[i];
+  memset(&sg, 0, sizeof(sg));
+  strncpy(sg.name, name.c_str(), sizeof(sg.name) - 1);
+  s.seg = i;
+  saveManifest();
+}
+
+void ClogFS::segAppend(int seg, size_t bytes, int sev){
+  if (!_manifestOk || seg < 0 || bytes == 0) return;
+  Segment& sg = _segs[seg];
+  sg.size += bytes;
+  if (sev >= TRACE && sev <= CRIT) {
+    if (sg.sevCount[sev] < 0xFFFF) sg.sevCount[sev]++;
+    time_t t = _nowFn ? _nowFn() : 0;
+    if (t > 0) {
+      if (!sg.first) sg.first = (uint32_t)t;
+      sg.last = (uint32_t)t;
+    }
+  }
+}
+
+// bloque ya formateado (boot buffer): severidad por prefijo de cada línea
+void ClogFS::segAppendBlock(int seg, const char* text, size_t n){
+  if (!_manifestOk || seg < 0 || !text) return;
+  for (const char* p = text, *end = text + n; p < end; ) {
+    const char* nl = (const char*)memchr(p, '\n', end - p);
+    size_t len = nl ? (size_t)(nl - p + 1) : (size_t)(end - p);
+    int sev = -1;
+    const char* q = p;
+    bool json = (strncmp(p, "{\"sev\":\"", 8) == 0);
+    if (json) q += 8;
+    for (int s = TRACE; s <= CRIT; ++s) {
+      const char* nm = sevName((Severity)s);
+      size_t k = strlen(nm);
+      if (strncmp(q, nm, k) == 0 && q[k] == (json ? '"' : ' ')) { sev = s; break; }
+    }
+    segAppend(seg, len, sev);
+    p += len;
+  }
+}
+
+// carga la tabla persistida y la reconcilia con un único recorrido del dir
+bool ClogFS::mountManifest(){
+  _segs.clear();
+  for (Sink& sk : _sink) sk.seg = -1;
+  _manifestOk = false;
+
+  std::vector<Segment> saved;
+  String idx = fullPathOf(manifestName());
+  if (LittleFS.exists(idx)) {
+    File m = LittleFS.open(idx, FILE_READ);
+    uint32_t magic = 0; uint16_t n = 0;
+    if (m && m.read((uint8_t*)&magic, 4) == 4 && magic == MANIFEST_MAGIC &&
+        m.read((uint8_t*)&n, 2) == 2) {
+      Segment sg;
+      for (uint16_t i = 0; i < n && m.read((uint8_t*)&sg, sizeof(sg)) == sizeof(sg); ++i) {
+        sg.name[sizeof(sg.name) - 1] = 0;
+        saved.push_back(sg);
+      }
+    }
+    if (m) m.close();
+  }
+
+  File dir = LittleFS.open(_basePath.c_str(), FILE_READ);
+  if (!dir || !dir.isDirectory()) return false;
+  for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+    String name = f.name();
+    name = name.substring(name.lastIndexOf('/') + 1);
+    bool isDir = f.isDirectory();
+    size_t sz = f.size();
+    f.close();
+    if (isDir || name == manifestName() || name.length() >= sizeof(Segment::name)) continue;
+
+    Segment sg;
+    memset(&sg, 0, sizeof(sg));
+    for (const auto& old : saved) {
+      if (name == old.name) { sg = old; break; }
+    }
+    strncpy(sg.name, name.c_str(), sizeof(sg.name) - 1);
+    sg.size = (uint32_t)sz;   // el tamaño real manda (p.ej. corte de energía)
+    _segs.push_back(sg);
+  }
+  dir.close();
+
+  std::sort(_segs.begin(), _segs.end(),
+            [](const Segment& a, const Segment& b){ return strcmp(a.name, b.name) < 0; });
+
+  _manifestOk = true;
+  for (uint8_t c = 0; c < _nChan; ++c) {
+    Sink& sk = _sink[c];
+    if (sk.ok) sk.seg = segIndex(sk.path.c_str() + sk.path.lastIndexOf('/') + 1);
+  }
+
+  // el último segmento de cada canal es el que pudo quedar a medio escribir
+  for (uint8_t c = 0; c < _nChan; ++c) {
+    int last = -1;
+    for (size_t i = 0; i < _segs.size(); ++i) {
+      if (channelOfFile(_segs[i].name) == (int)c) last = (int)i;   // ordenado por nombre
+    }
+    if (last < 0 || isOpenFile(_segs[last].name)) continue;
+    RecoverInfo ri;
+    String full = fullPathOf(_segs[last].name);
+    if (recoverTail(full.c_str(), &ri)) {
+      File f = LittleFS.open(full, FILE_READ);
+      if (f) { _segs[last].size = (uint32_t)f.size(); f.close(); }
+      if (ri.dropped)
+        warn(F("fs: recovered %s kept=%lu dropped=%lu bad=%lu in %lu us"), _segs[last].name,
+             (unsigned long)ri.kept, (unsigned long)ri.dropped, (unsigned long)ri.badFrames,
+             (unsigned long)ri.micros);
+    }
+  }
+  return saveManifest();
+}
+
+// formato: magic(4) + count(2) + count * Segment
+bool ClogFS::saveManifest(){
+  if (!_manifestOk) return false;
+  File m = LittleFS.open(fullPathOf(manifestName()), FILE_WRITE);
+  if (!m) return false;
+  uint16_t n = (uint16_t)_segs.size();
+  bool ok = m.write((const uint8_t*)&MANIFEST_MAGIC, 4) == 4 &&
+            m.write((const uint8_t*)&n, 2) == 2;
+  if (ok && n) ok = m.write((const uint8_t*)_segs.data(), n * sizeof(Segment)) == n * sizeof(Segment);
+  m.close();
+  return ok;
+}
+
+// borra archivo + entrada (el activo no se toca)
+bool ClogFS::removeSegment(const char* name){
+  int i = segIndex(name);
+  if (i < 0) return false;
+  if (isOpenFile(name)) return false;
+  String full = fullPathOf(name);
+  if (!LittleFS.remove(full) && LittleFS.exists(full)) return false;   // ya no estaba: fuera del manifest
+
+  _segs.erase(_segs.begin() + i);
+  for (Sink& sk : _sink) {
+    if (sk.seg > i) sk.seg--;
+  }
+  saveManifest();
+  return true;
+}
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// canales + retención
+// ─────────────────────────────────────────────────────────────────────────────
+int ClogFS::addChannel(const char* name, Severity minSev, uint32_t quotaBytes, uint32_t maxFileBytes){
+  if (!name || !*name || strlen(name) >= sizeof(Chan::name)) return -1;
+  for (const char* p = name; *p; ++p) {
+    if (!isalnum((unsigned char)*p) && *p != '_') return -1;   // '-' separa prefijo y fecha
+  }
+  int i = channel(name);
+  if (i < 0) {
+    if (_nChan >= CLOGFS_CHANNELS) return -1;
+    i = _nChan++;
+    strcpy(_chan[i].name, name);
+  }
+  if (!setChannelQuota((uint8_t)i, quotaBytes, maxFileBytes)) return -1;   // "log" + maxFile
+  _chan[i].minSev = minSev;
+  return i;
+}
+
+int ClogFS::channel(const char* name) const {
+  for (uint8_t c = 0; c < _nChan; ++c) {
+    if (name && strcmp(_chan[c].name, name) == 0) return c;
+  }
+  return -1;
+}
+
+void ClogFS::setChannelMinSeverity(uint8_t ch, Severity s){
+  if (ch < _nChan) _chan[ch].minSev = s;
+}
+
+// con cuota y sin tamaño máximo se rota cada quota/4: así la retención
+// borra archivos enteros sin dejar al canal en cero. El canal 0 no rota
+// por tamaño (sinkFor no lo reabre): su cuota sólo borra archivos cerrados
+bool ClogFS::setChannelQuota(uint8_t ch, uint32_t quotaBytes, uint32_t maxFileBytes){
+  if (ch >= _nChan || (ch == 0 && maxFileBytes)) return false;
+  _chan[ch].quota   = quotaBytes;
+  _chan[ch].maxFile = (ch == 0) ? 0 : (maxFileBytes || !quotaBytes) ? maxFileBytes : quotaBytes / 4;
+  return true;
+}
+
+// "<canal>-YYYYMMDD-HHMMSS.ext"
+int ClogFS::channelOfFile(const char* name) const {
+  for (uint8_t c = 0; c < _nChan; ++c) {
+    size_t k = strlen(_chan[c].name);
+    if (strncmp(name, _chan[c].name, k) == 0 && name[k] == '-' && isdigit((unsigned char)name[k + 1]))
+      return c;
+  }
+  return -1;
+}
+
+uint32_t ClogFS::channelBytes(size_t ch) const {
+  uint32_t total = 0;
+  for (const Segment& sg : _segs) {
+    if (channelOfFile(sg.name) == (int)ch) total += sg.size;
+  }
+  return total;
+}
+
+// segmento cerrado más viejo del canal (ch < 0: de cualquier canal), por
+// la fecha del nombre
+int ClogFS::oldestSegment(int ch) const {
+  int best = -1;
+  const char* bestStamp = nullptr;
+  for (size_t i = 0; i < _segs.size(); ++i) {
+    int c = channelOfFile(_segs[i].name);
+    if (c < 0 || (ch >= 0 && c != ch) || isOpenFile(_segs[i].name)) continue;
+    const char* stamp = _segs[i].name + strlen(_chan[c].name) + 1;
+    if (!bestStamp || strcmp(stamp, bestStamp) < 0) { best = (int)i; bestStamp = stamp; }
+  }
+  return best;
+}
+
+bool ClogFS::retentionActive() const {
+  if (_budget) return true;
+  for (uint8_t c = 0; c < _nChan; ++c) {
+    if (_chan[c].quota) return true;
+  }
+  return false;
+}
+
+// cuotas por canal y después el presupuesto global; nunca el activo
+void ClogFS::enforceRetention(){
+  if (!_manifestOk) return;
+  for (uint8_t c = 0; c < _nChan; ++c) {
+    if (!_chan[c].quota) continue;
+    while (channelBytes(c) > _chan[c].quota) {
+      int i = oldestSegment(c);
+      if (i < 0 || !removeSegment(_segs[i].name)) break;
+    }
+  }
+  while (_budget) {
+    uint32_t total = 0;
+    for (const Segment& sg : _segs) {
+      if (channelOfFile(sg.name) >= 0) total += sg.size;
+    }
+    if (total <= _budget) break;
+    int i = oldestSegment(-1);
+    if (i < 0 || !removeSegment(_segs[i].name)) break;
+  }
+}
+
+// low-water: primero los segmentos cerrados más viejos de cualquier canal;
+// false = no alcanzó (el llamador hace el wipe de siempre)
+bool ClogFS::reclaim(size_t need){
+  for (;;) {
+    size_t freeB = fsFreeBytes();
+    if (freeB == 0 || freeB >= need + _fsLowWater) return true;
+    int i = _manifestOk ? oldestSegment(-1) : -1;
+    if (i < 0 || !removeSegment(_segs[i].name)) return false;
+  }
+}
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// staging (PSRAM) + vaciado en bloques
+// ─────────────────────────────────────────────────────────────────────────────
+#if defined(ARDUINO_ARCH_ESP32)
+  #define STAGE_LOCK()    portENTER_CRITICAL(&_stageMux)
+  #define STAGE_UNLOCK()  portEXIT_CRITICAL(&_stageMux)
+#else
+  #define STAGE_LOCK()
+  #define STAGE_UNLOCK()
+#endif
+
+void ClogFS::lockFile(){
+#if defined(ARDUINO_ARCH_ESP32)
+  if (_fileMux) xSemaphoreTakeRecursive(_fileMux, portMAX_DELAY);
+#endif
+}
+
+void ClogFS::unlockFile(){
+#if defined(ARDUINO_ARCH_ESP32)
+  if (_fileMux) xSemaphoreGiveRecursive(_fileMux);
+#endif
+}
+
+bool ClogFS::enableStaging(size_t bytes, size_t blockBytes, uint8_t highPct, uint8_t lowPct){
+  disableStaging();
+  if (blockBytes < 512) blockBytes = 512;
+  if (blockBytes > CLOGFS_FRAME_MAX) blockBytes = CLOGFS_FRAME_MAX;
+  if (bytes < 4 * blockBytes) bytes = 4 * blockBytes;
+  if (highPct > 100) highPct = 100;
+  if (lowPct >= highPct) lowPct = highPct / 2;
+
+  // PSRAM si la placa tiene; si no, heap común (en un host Linux, malloc)
+  uint8_t* mem = nullptr;
+  _stagePsram = false;
+#if defined(ARDUINO_ARCH_ESP32)
+  if (psramFound()) { mem = (uint8_t*)ps_malloc(bytes); _stagePsram = (mem != nullptr); }
+#endif
+  if (!mem) mem = (uint8_t*)malloc(bytes);
+  _drainBuf = (uint8_t*)malloc(2 * blockBytes);
+  if (!mem || !_drainBuf) {
+    free(mem); free(_drainBuf); _drainBuf = nullptr;
+    return false;
+  }
+
+  _stageBlock   = blockBytes;
+  _stageHigh    = bytes * highPct / 100;
+  _stageLow     = bytes * lowPct  / 100;
+  _stagePeak    = 0;
+  _stageStalls  = _stageDropped = 0;
+  _stageIn      = _stageOut = 0;
+  _stageT0      = _rateWinT0 = millis();
+  _rateWinBytes = _ratePeak = 0;
+
+#if defined(ARDUINO_ARCH_ESP32)
+  if (!_fileMux) _fileMux = xSemaphoreCreateRecursiveMutex();
+#endif
+  STAGE_LOCK();
+  _stage.attach(mem, bytes);
+  STAGE_UNLOCK();
+#if defined(ARDUINO_ARCH_ESP32)
+  xTaskCreatePinnedToCore(stageTask, "clogfs_drain", 4096, this, 1, &_stageTaskH, tskNO_AFFINITY);
+#endif
+  return true;
+}
+
+void ClogFS::disableStaging(){
+  if (!stagingEnabled()) return;
+  lockFile();
+  flushStaging();
+#if defined(ARDUINO_ARCH_ESP32)
+  if (_stageTaskH) { vTaskDelete(_stageTaskH); _stageTaskH = nullptr; }
+#endif
+  STAGE_LOCK();
+  uint8_t* mem = _stage.detach();
+  STAGE_UNLOCK();
+  free(mem);
+  free(_drainBuf);
+  _drainBuf = nullptr;
+  unlockFile();
+}
+
+// ¿esta tarea está adentro de stageDrainOnce()? (un log del propio vaciado
+// va directo al archivo; el de otra tarea sigue entrando al ring)
+bool ClogFS::drainingHere() const {
+#if defined(ARDUINO_ARCH_ESP32)
+  return _inDrain && _drainOwner == xTaskGetCurrentTaskHandle();
+#else
+  return _inDrain;
+#endif
+}
+
+// vaciado síncrono de todo lo pendiente (rotate/close/disable)
+void ClogFS::flushStaging(){
+  if (!stagingEnabled() || drainingHere()) return;
+  lockFile();
+  while (_stage.used() > 0 && stageDrainOnce() > 0) {}
+  unlockFile();
+}
+
+void ClogFS::stagePush(uint8_t ch, const char* line, Severity sev){
+  size_t len  = strlen(line);
+  size_t need = len + 2;                       // igual que println: "\r\n"
+
+  // backpressure: sobre high, esperar a que el drenaje baje a low. Con
+  // aviso se vacían sólo bloques completos: con low < bloque, el piso es
+  // lo que queda de un bloque incompleto
+  if (_stage.used() + need > _stageHigh) {
+    STAGE_LOCK();
+    _stageStalls++;
+    STAGE_UNLOCK();
+    size_t floor = (_stageLow >= _stageBlock) ? _stageLow : _stageBlock - 1;
+    uint32_t t0 = millis();
+    while (_stage.used() > floor && _sink[0].ok && (millis() - t0) < 2000) {
+      stageKick();
+#if defined(ARDUINO_ARCH_ESP32)
+      delay(1);
+#endif
+    }
+  }
+
+  // el manifest se actualiza al escribir: recién ahí se sabe en qué
+  // archivo del canal cae la línea
+  uint8_t h[4] = { ch, (uint8_t)sev, (uint8_t)(need & 0xFF), (uint8_t)(need >> 8) };
+  uint32_t now = millis();
+  bool ok;
+  STAGE_LOCK();
+  ok = _stage.room() >= sizeof(h) + need;
+  if (ok) {
+    _stage.push(h, sizeof(h));
+    _stage.push(line, len);
+    _stage.push("\r\n", 2);
+
+    // tasas: sostenida desde enable, pico por ventana de 1 s
+    _stageIn += need;
+    _rateWinBytes += need;
+    if (now - _rateWinT0 >= 1000) {
+      uint32_t bps = (uint32_t)((uint64_t)_rateWinBytes * 1000 / (now - _rateWinT0));
+      if (bps > _ratePeak) _ratePeak = bps;
+      _rateWinT0 = now;
+      _rateWinBytes = 0;
+    }
+  } else {
+    _stageDropped++;
+  }
+  size_t used = _stage.used();
+  if (used > _stagePeak) _stagePeak = used;
+  STAGE_UNLOCK();
+  if (!ok) return;
+
+  if (used >= _stageBlock) stageKick();
+}
+
+// despierta a la tarea; sin tarea (host) vacía en línea
+void ClogFS::stageKick(){
+#if defined(ARDUINO_ARCH_ESP32)
+  if (_stageTaskH) { xTaskNotifyGive(_stageTaskH); return; }
+#endif
+  lockFile();
+  while (_stage.used() >= _stageBlock && stageDrainOnce() > 0) {}
+  unlockFile();
+}
+
+// un bloque del ring a los archivos (llamar con lockFile tomado). Los
+// registros enteros que entran en _stageBlock se agrupan por canal: una
+// escritura (y un bloque enmarcado) por canal presente.
+size_t ClogFS::stageDrainOnce(){
+  if (!stagingEnabled() || !_sink[0].ok) return 0;
+
+  uint8_t* rec = _drainBuf;
+  uint8_t* out = _drainBuf + _stageBlock;
+  STAGE_LOCK();
+  size_t n = _stage.peek(rec, _stageBlock);
+  size_t cut = 0;
+  while (cut + 4 <= n) {
+    size_t len = rec[cut + 2] | (rec[cut + 3] << 8);
+    if (cut + 4 + len > n) break;
+    cut += 4 + len;
+  }
+  _stage.drop(cut);
+  STAGE_UNLOCK();
+  if (!cut) return 0;
+
+  _inDrain = true;
+#if defined(ARDUINO_ARCH_ESP32)
+  _drainOwner = xTaskGetCurrentTaskHandle();
+#endif
+  size_t drained = 0;
+  for (uint8_t ch = 0; ch < _nChan; ++ch) {
+    size_t m = 0;
+    for (size_t off = 0; off < cut; off += 4 + (rec[off + 2] | (rec[off + 3] << 8))) {
+      size_t len = rec[off + 2] | (rec[off + 3] << 8);
+      if (rec[off] != ch) continue;
+      memcpy(out + m, rec + off + 4, len);
+      m += len;
+    }
+    if (!m) continue;
+
+    size_t freeB = fsFreeBytes();
+    if (freeB > 0 && freeB < (m + _fsLowWater) && !reclaim(m)) {
+      closeFile();
+      wipeAllInBasePath();
+      reopenFreshFileAfterWipe("FS_WIPE=1");
+    }
+
+    Sink* s = sinkFor(ch);
+    if (s) frameRoom(*s, m);
+    size_t w = s ? fileWrite(*s, out, m) : 0;
+    if (w < m) {
+      wipeAllInBasePath();
+      s = reopenFreshFileAfterWipe("FS_WIPE=1") ? sinkFor(ch) : nullptr;
+      w = s ? fileWrite(*s, out, m) : 0;
+    }
+    if (!s || !w) continue;
+
+    bool crit = false;
+    for (size_t off = 0; off < cut; off += 4 + (rec[off + 2] | (rec[off + 3] << 8))) {
+      if (rec[off] != ch) continue;
+      segAppend(s->seg, rec[off + 2] | (rec[off + 3] << 8), rec[off + 1]);
+      crit |= (rec[off + 1] == CRIT && _critFlush);
+    }
+    // el bloque se cierra por tamaño, no por pasada: un canal con pocas
+    // líneas por bloque no paga un trailer cada vez
+    if (crit || s->frameLen >= CLOGFS_FRAME_BYTES) frameClose(*s);
+    s->file.flush();
+    drained += m;
+  }
+  _inDrain = false;
+#if defined(ARDUINO_ARCH_ESP32)
+  _drainOwner = nullptr;
+#endif
+
+  STAGE_LOCK();
+  _stageOut += drained;
+  STAGE_UNLOCK();
+  return cut;
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+void ClogFS::stageTask(void* arg){
+  ClogFS* self = (ClogFS*)arg;
+  for (;;) {
+    // aviso = hay bloque(s) completo(s); timeout = vaciar también el resto
+    bool kicked = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(500)) > 0;
+    self->lockFile();
+    while (self->_stage.used() >= (kicked ? self->_stageBlock : 1)) {
+      if (!self->stageDrainOnce()) break;
+    }
+    self->unlockFile();
+  }
+}
+#endif
+
+ClogFS::StageStats ClogFS::stagingStats() const {
+  StageStats st;
+  uint32_t now = millis();
+  STAGE_LOCK();                // los contadores, de una misma vez
+  st.capacity = _stage.capacity();
+  st.used     = _stage.used();
+  st.peakUsed = _stagePeak;
+  st.inPsram  = _stagePsram;
+  st.stalls   = _stageStalls;
+  st.dropped  = _stageDropped;
+  st.ingested = _stageIn;
+  st.drained  = _stageOut;
+  st.peakBps  = _ratePeak;
+  uint32_t t0 = _stageT0;
+  STAGE_UNLOCK();
+  uint32_t el = now - t0;
+  st.avgBps   = el ? (uint32_t)(st.ingested * 1000 / el) : 0;
+  return st;
+}
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// muestreo por sitio
+// ─────────────────────────────────────────────────────────────────────────────
+ClogFS::SampleSite* ClogFS::sampleSiteFor(const __FlashStringHelper* fmt, bool create){
+  for (uint8_t i = 0; i < _nSites; ++i) {
+    if (_sites[i].fmt == fmt) return &_sites[i];
+  }
+  if (!create || !fmt || _nSites >= CLOGFS_SAMPLE_SITES) return nullptr;
+  SampleSite& s = _sites[_nSites++];
+  memset(&s, 0, sizeof(s));
+  s.fmt = fmt;
+  return &s;
+}
+
+bool ClogFS::sampleEvery(const __FlashStringHelper* fmt, uint16_t n){
+  SampleSite* s = sampleSiteFor(fmt, true);
+  if (!s) return false;
+  s->every = n;
+  return true;
+}
+
+bool ClogFS::sampleInterval(const __FlashStringHelper* fmt, uint32_t ms){
+  SampleSite* s = sampleSiteFor(fmt, true);
+  if (!s) return false;
+  s->intervalMs = ms;
+  s->lastMs = millis() - ms;   // el primero pasa
+  return true;
+}
+
+void ClogFS::clearSampling(const __FlashStringHelper* fmt){
+  SampleSite* s = sampleSiteFor(fmt, false);
+  if (!s) return;
+  *s = _sites[--_nSites];
+}
+
+// fast path: comparación de punteros, sin formateo
+bool ClogFS::sampleAdmit(const __FlashStringHelper* fmt){
+  SampleSite* s = sampleSiteFor(fmt, false);
+  if (!s) return true;
+
+  s->seen++;
+  if (s->every > 1 && ((s->seen - 1) % s->every) != 0) return false;
+  if (s->intervalMs) {
+    uint32_t now = millis();
+    if (now - s->lastMs < s->intervalMs) return false;
+    s->lastMs = now;
+  }
+  s->written++;
+  return true;
+}
+
+void ClogFS::loop(){
+  if (_shedSummaryMs && (millis() - _shedSummaryT0) >= _shedSummaryMs) {
+    _shedSummaryT0 = millis();
+    uint32_t t = _shedPeriod[TRACE], d = _shedPeriod[DEBUG], i = _shedPeriod[INFO];
+    if (t || d || i) {
+      _shedPeriod[TRACE] = _shedPeriod[DEBUG] = _shedPeriod[INFO] = 0;
+      // WARN y sin umbral: la sobrecarga queda en el historial aunque el
+      // canal 0 filtre WARN
+      notice(WARN, F("log: overload shed TRACE=%lu DEBUG=%lu INFO=%lu fill=%u%%"),
+             (unsigned long)t, (unsigned long)d, (unsigned long)i, (unsigned)bufferFillPct());
+    }
+  }
+  if (_nSites && _sampleSummaryMs && (millis() - _sampleSummaryT0) >= _sampleSummaryMs) {
+    _sampleSummaryT0 = millis();
+    sampleSummary();
+  }
+  // bloques abiertos de canales tranquilos: se cierran por edad
+  for (uint8_t c = 0; c < _nChan; ++c) {
+    if (!_sink[c].frameLen || (millis() - _sink[c].frameT0) < CLOGFS_FRAME_MS) continue;
+    lockFile();
+    Sink& s = _sink[c];
+    if (s.frameLen && (millis() - s.frameT0) >= CLOGFS_FRAME_MS) {
+      frameClose(s);
+      s.file.flush();
+    }
+    unlockFile();
+  }
+  // los activos crecen entre rotaciones: cuotas / presupuesto cada tanto
+  if (retentionActive() && (millis() - _retainT0) >= 5000) {
+    _retainT0 = millis();
+    lockFile();
+    enforceRetention();
+    unlockFile();
+  }
+}
+
+// una línea por sitio con actividad: eventos producidos vs escritos
+void ClogFS::sampleSummary(){
+  for (uint8_t i = 0; i < _nSites; ++i) {
+    SampleSite& s = _sites[i];
+    if (!s.seen) continue;
+    uint32_t seen = s.seen, written = s.written;
+    s.seen = s.written = 0;
+    // sin umbral: con el canal en WARN el muestreo es lo que más importa ver
+    notice(INFO, F("sample: seen=%lu written=%lu fmt=\"%.32s\""),
+         (unsigned long)seen, (unsigned long)written, (PGM_P)s.fmt);
+  }
+}
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// caché reciente
+// ─────────────────────────────────────────────────────────────────────────────
+bool ClogFS::setRecentCacheBytes(size_t bytes){
+  _recentBase += (uint32_t)_recent.used();    // un cursor abierto queda al final
+  free(_recent.detach());
+  if (!bytes) return true;
+  if (bytes < 512) bytes = 512;
+  uint8_t* mem = (uint8_t*)malloc(bytes);
+  if (!mem) return false;
+  _recent.attach(mem, bytes);
+  return true;
+}
+
+void ClogFS::recentAppend(uint8_t ch, Severity sev, const char* line){
+  if (!_recent.capacity()) return;
+  size_t len = strlen(line);
+  if (len + 3 > _recent.capacity()) return;
+
+  // hacer lugar tirando los registros más viejos
+  while (_recent.room() < len + 3) {
+    uint8_t h[3];
+    _recent.peek(h, 3);
+    size_t n = 3 + (h[1] | (h[2] << 8));
+    _recent.drop(n);
+    _recentBase += (uint32_t)n;
+  }
+  uint8_t h[3] = { (uint8_t)(sev | (ch << 4)), (uint8_t)(len & 0xFF), (uint8_t)(len >> 8) };
+  _recent.push(h, 3);
+  _recent.push(line, len);
+}
+
+// las últimas maxLines (0 = todas) con sev >= minSev, de la más vieja a la más nueva;
+// ch >= 0 filtra por canal
+size_t ClogFS::forEachRecent(Severity minSev, size_t maxLines, RecentFn fn, void* ctx, int ch) const {
+  RecentCursor rc;
+  recentOpen(rc, minSev, maxLines, ch);
+  char line[256];
+  size_t len, n = 0;
+  Severity sev;
+  bool trunc;
+  while (recentNext(rc, line, sizeof(line), &len, &sev, &trunc)) {
+    fn(ctx, sev, line, len, trunc);
+    n++;
+  }
+  return n;
+}
+
+void ClogFS::recentOpen(RecentCursor& rc, Severity minSev, size_t maxLines, int ch) const {
+  rc.minSev = (uint8_t)minSev;
+  rc.ch     = (int8_t)ch;
+  rc.end    = _recentBase + (uint32_t)_recent.used();
+  rc.pos    = rc.end;
+
+  uint8_t h[3];
+  size_t match = 0;
+  for (size_t off = 0; _recent.peek(h, 3, off) == 3; off += 3 + (h[1] | (h[2] << 8))) {
+    if ((h[0] & 0x0F) >= minSev && (ch < 0 || (h[0] >> 4) == ch)) match++;
+  }
+  size_t skip = (maxLines && match > maxLines) ? match - maxLines : 0;
+  for (size_t off = 0; _recent.peek(h, 3, off) == 3; off += 3 + (h[1] | (h[2] << 8))) {
+    if ((h[0] & 0x0F) < minSev || (ch >= 0 && (h[0] >> 4) != ch)) continue;
+    if (skip) { skip--; continue; }
+    rc.pos = _recentBase + (uint32_t)off;
+    break;
+  }
+}
+
+// trunc: el registro no entra en cap - 1 bytes (se entrega cortado)
+bool ClogFS::recentNext(RecentCursor& rc, char* line, size_t cap, size_t* len, Severity* sev, bool* trunc) const {
+  if ((int32_t)(rc.pos - _recentBase) < 0) rc.pos = _recentBase;   // ya descartados
+  uint8_t h[3];
+  while ((int32_t)(rc.end - rc.pos) > 0) {
+    size_t off = rc.pos - _recentBase;
+    if (_recent.peek(h, 3, off) != 3) break;
+    size_t n = h[1] | (h[2] << 8);
+    rc.pos += (uint32_t)(3 + n);
+    if ((h[0] & 0x0F) < rc.minSev || (rc.ch >= 0 && (h[0] >> 4) != rc.ch)) continue;
+    *trunc = n >= cap;
+    if (*trunc) n = cap - 1;
+    _recent.peek((uint8_t*)line, n, off + 3);
+    line[n] = 0;
+    *len = n;
+    *sev = (Severity)(h[0] & 0x0F);
+    return true;
+  }
+  rc.pos = rc.end;
+  return false;
+}
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// admisión por severidad
+// ─────────────────────────────────────────────────────────────────────────────
+void ClogFS::setShedWatermarks(uint8_t tracePct, uint8_t debugPct, uint8_t infoPct){
+  if (infoPct > 100)     infoPct  = 100;
+  if (debugPct > infoPct) debugPct = infoPct;
+  if (tracePct > debugPct) tracePct = debugPct;
+  _shedPct[TRACE] = tracePct;
+  _shedPct[DEBUG] = debugPct;
+  _shedPct[INFO]  = infoPct;
+}
+
+// llenado del buffer que está absorbiendo escrituras
+uint8_t ClogFS::bufferFillPct() const {
+  if (stagingEnabled()) return (uint8_t)(_stage.used() * 100 / _stage.capacity());
+  if (!(_sink[0].ready && _sink[0].ok)) {
+    if (!_bootCap) return 0;
+    size_t pct = _bootBuf.length() * 100 / _bootCap;
+    return (uint8_t)(pct > 100 ? 100 : pct);
+  }
+  // archivo abierto sin staging: ocupación de la escritura directa (una
+  // ventana sin escrituras ya no cuenta)
+  if (micros() - _wrWinT0 >= 2 * CLOGFS_BUSY_WINDOW_US) return 0;
+  return _wrBusyPct;
+}
+
+bool ClogFS::admit(Severity sev){
+  if (sev >= WARN) return true;
+  if (bufferFillPct() < _shedPct[sev]) return true;
+  _shed[sev]++;
+  _shedPeriod[sev]++;
+  return false;
+}
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// JSON Lines
+// ─────────────────────────────────────────────────────────────────────────────
+// cabecera del archivo: texto tal cual, o {"header":"..."} en JSONL
+void ClogFS::writeHeader(Sink& s, const char* header_ascii){
+  if (!s.ok || !header_ascii || !*header_ascii) return;
+  if (s.fmt == FMT_JSONL) {
+    char hb[160];
+    JsonWriter w(hb, sizeof(hb));
+    w.raw("{").key("header").str(header_ascii).raw("}");
+    if (w.overflow()) return;
+    segAppend(s.seg, fileWrite(s, hb, w.length()) + fileWrite(s, "\r\n", 2), -1);
+  } else {
+    segAppend(s.seg, fileWrite(s, header_ascii, strlen(header_ascii)) + fileWrite(s, "\r\n", 2), -1);
+  }
+  s.file.flush();
+}
+
+// {"sev":..,"ts"|"ms":..,"id":..,"name"|"fmt":..,"args":[..],"msg":..}
+// sev va primero: segAppendBlock lo reconoce por prefijo. Los argumentos
+// se tipan recorriendo el formato (en flash) igual que vsnprintf.
+size_t ClogFS::buildJson(char* out, size_t cap, uint8_t ch, Severity sev,
+                         const __FlashStringHelper* fmt, va_list ap, const char* msg){
+  JsonWriter w(out, cap);
+  int id = -1;
+  const char* name = _nameFn ? _nameFn(fmt, &id) : nullptr;
+
+  char ts[32] = {0};
+  time_t t = _nowFn ? _nowFn() : 0;
+  struct tm* tm_info = (t > 0) ? localtime(&t) : nullptr;
+  if (tm_info) strftime(ts, sizeof(ts), "%Y-%m-%dT%H:%M:%S%z", tm_info);
+
+  // sev/ts/id/nombre: siempre entran en cap (se reusan si algo desborda)
+  w.raw("{").key("sev").str(sevName(sev));
+  if (ch) w.key("ch").str(_chan[ch].name);
+  if (*ts) w.key("ts").str(ts);
+  else     w.key("ms").u64(millis());
+  if (name) { w.key("id").i64(id); w.key("name").str(name); }
+  size_t fixedLen = w.length();
+
+  if (!name) {
+    char f[96];
+    strncpy_P(f, (PGM_P)fmt, sizeof(f) - 1);
+    f[sizeof(f) - 1] = 0;
+    w.key("fmt").str(f);
+  }
+
+  w.key("args").raw("[");
+  PGM_P p = (PGM_P)fmt;
+  bool typed = true;
+  for (char c = pgm_read_byte(p); c && typed; c = pgm_read_byte(++p)) {
+    if (c != '%') continue;
+    c = pgm_read_byte(++p);
+    if (c == '%') continue;
+    if (!c) break;
+
+    // flags, ancho, precisión
+    while (c && strchr("-+ #0", c)) c = pgm_read_byte(++p);
+    if (c == '*') { (void)va_arg(ap, int); c = pgm_read_byte(++p); }
+    while (c >= '0' && c <= '9') c = pgm_read_byte(++p);
+    int prec = -1;
+    if (c == '.') {
+      prec = 0;
+      c = pgm_read_byte(++p);
+      if (c == '*') { prec = va_arg(ap, int); c = pgm_read_byte(++p); }
+      while (c >= '0' && c <= '9') { prec = prec * 10 + (c - '0'); c = pgm_read_byte(++p); }
+    }
+    // largo
+    int lng = 0;          // 0 int, 1 long, 2 long long, 3 size_t, 4 intmax_t
+    while (c && strchr("hlzjtL", c)) {
+      if (c == 'l') lng = lng ? 2 : 1;
+      else if (c == 'z' || c == 't') lng = 3;
+      else if (c == 'j') lng = 4;
+      c = pgm_read_byte(++p);
+    }
+    if (!c) break;
+
+    w.comma();
+    switch (c) {
+      case 'd': case 'i':
+        if      (lng == 1) w.i64(va_arg(ap, long));
+        else if (lng == 2) w.i64(va_arg(ap, long long));
+        else if (lng == 3) w.i64((int64_t)va_arg(ap, ssize_t));
+        else if (lng == 4) w.i64(va_arg(ap, intmax_t));
+        else               w.i64(va_arg(ap, int));
+        break;
+      case 'u': case 'x': case 'X': case 'o':
+        if      (lng == 1) w.u64(va_arg(ap, unsigned long));
+        else if (lng == 2) w.u64(va_arg(ap, unsigned long long));
+        else if (lng == 3) w.u64(va_arg(ap, size_t));
+        else if (lng == 4) w.u64(va_arg(ap, uintmax_t));
+        else               w.u64(va_arg(ap, unsigned int));
+        break;
+      case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        w.f64(va_arg(ap, double), (c == 'f' || c == 'F') ? prec : -1);
+        break;
+      case 'c': {
+        char ch = (char)va_arg(ap, int);
+        w.str(&ch, 1);
+        break;
+      }
+      case 's': {
+        const char* s = va_arg(ap, const char*);
+        if (!s) { w.raw("null"); break; }
+        size_t n = strlen(s);
+        if (prec >= 0 && (size_t)prec < n) n = (size_t)prec;
+        w.str(s, n);
+        break;
+      }
+      case 'p': {
+        char ptr[20];
+        snprintf(ptr, sizeof(ptr), "%p", va_arg(ap, void*));
+        w.str(ptr);
+        break;
+      }
+      default:            // %n u otro: no se puede tipar, corto acá
+        w.raw("null");
+        typed = false;
+        break;
+    }
+  }
+  w.raw("]").key("msg").str(msg).raw("}");
+
+  // no entró: lo fijo + msg recortado hasta que entre + trunc
+  if (w.overflow()) {
+    for (size_t n = strlen(msg); ; n /= 2) {
+      out[fixedLen] = 0;
+      JsonWriter r(out + fixedLen, cap - fixedLen);
+      r.raw(",\"msg\":").str(msg, n).raw(",\"trunc\":true}");
+      if (!r.overflow() || n == 0) return fixedLen + r.length();
+    }
+  }
+  return w.length();
+}
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// bloques enmarcados + recuperación
+// ─────────────────────────────────────────────────────────────────────────────
+// toda escritura a un archivo activo pasa por acá (CRC del bloque abierto)
+size_t ClogFS::fileWrite(Sink& s, const void* data, size_t n){
+  size_t w = s.file.write((const uint8_t*)data, n);
+  if (_framing && w) {
+    if (!s.frameLen) s.frameT0 = millis();
+    s.frameCrc = crc32(s.frameCrc, data, w);
+    s.frameLen += w;
+  }
+  return w;
+}
+
+// antes de una unidad completa (línea / bloque): no pasar de CLOGFS_FRAME_MAX
+void ClogFS::frameRoom(Sink& s, size_t n){
+  if (s.frameLen && s.frameLen + n > CLOGFS_FRAME_MAX) frameClose(s);
+}
+
+void ClogFS::frameClose(Sink& s){
+  if (!_framing || !s.frameLen || !s.file) return;
+  char t[40];
+  int n = (s.fmt == FMT_JSONL)
+        ? snprintf(t, sizeof(t), "{\"#F\":\"%08lx %04lx %08lx\"}\r\n", (unsigned long)s.frameSeq,
+                   (unsigned long)s.frameLen, (unsigned long)s.frameCrc)
+        : snprintf(t, sizeof(t), "#F %08lx %04lx %08lx\r\n", (unsigned long)s.frameSeq,
+                   (unsigned long)s.frameLen, (unsigned long)s.frameCrc);
+  segAppend(s.seg, s.file.write((const uint8_t*)t, n), -1);
+  s.frameSeq++;
+  s.frameLen = 0;
+  s.frameCrc = 0;
+}
+
+// CRC-32 (IEEE, reflejado); encadenable: crc32(crc32(0, a), b) == crc32(0, a+b)
+uint32_t ClogFS::crc32(uint32_t crc, const void* data, size_t n){
+#if defined(ARDUINO_ARCH_ESP32)
+  return esp_rom_crc32_le(crc, (const uint8_t*)data, n);
+#else
+  static const uint32_t tbl[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C };
+  const uint8_t* p = (const uint8_t*)data;
+  crc = ~crc;
+  while (n--) {
+    crc ^= *p++;
+    crc = (crc >> 4) ^ tbl[crc & 15];
+    crc = (crc >> 4) ^ tbl[crc & 15];
+  }
+  return ~crc;
+#endif
+}
+
+// línea sin "\r\n": "#F ssssssss llll cccccccc" o {"#F":"ssssssss llll cccccccc"}
+bool ClogFS::parseFrameTrailer(const char* s, size_t n, uint32_t* seq, uint32_t* len, uint32_t* crc){
+  if (n && s[n - 1] == '\r') --n;
+  const char* p;
+  if      (n == 25 && memcmp(s, "#F ", 3) == 0) p = s + 3;
+  else if (n == 31 && memcmp(s, "{\"#F\":\"", 7) == 0 && memcmp(s + 29, "\"}", 2) == 0) p = s + 7;
+  else return false;
+  if (p[8] != ' ' || p[13] != ' ') return false;
+
+  auto hex = [](const char* h, int digits, uint32_t* out) -> bool {
+    uint32_t v = 0;
+    for (int i = 0; i < digits; ++i) {
+      char c = h[i];
+      int d = (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+      if (d < 0) return false;
+      v = (v << 4) | (uint32_t)d;
+    }
+    *out = v;
+    return true;
+  };
+  return hex(p, 8, seq) && hex(p + 9, 4, len) && hex(p + 14, 8, crc);
+}
+
+// la API de FS no trunca: se va por el VFS (en el host, el directorio raíz)
+bool ClogFS::truncateFile(const String& fullPath, size_t len){
+  return ::truncate((_mountPoint + fullPath).c_str(), (off_t)len) == 0;
+}
+
+// Cola del archivo tras un corte de energía. Se lee de atrás hacia
+// adelante por ventanas (CLOGFS_FRAME_MAX + margen: ningún bloque la
+// supera) hasta el último trailer cuyo CRC verifica. Los bloques cerrados
+// después de ese punto que no verifican se descartan; lo que sigue al
+// último trailer (bloque sin cerrar) se conserva si son líneas completas
+// sin 0x00/0xFF. El resto se trunca y se marca con "#X dropped=N". En el
+// caso normal se lee una ventana: el costo no depende del tamaño del
+// archivo, sólo de cuántos bloques del final estén dañados.
+bool ClogFS::recoverTail(const char* path, RecoverInfo* info){
+  RecoverInfo ri;
+  memset(&ri, 0, sizeof(ri));
+  uint32_t t0 = micros();
+  String full = (path && path[0] == '/') ? String(path) : fullPathOf(path ? path : "");
+  bool jsonl = full.endsWith(".jsonl");
+
+  File f = LittleFS.open(full, FILE_READ);
+  if (!f || f.isDirectory()) return false;
+  const size_t cap = (size_t)CLOGFS_FRAME_MAX + 512;
+  size_t size = f.size();
+  uint8_t* buf = size ? (uint8_t*)malloc(size < cap ? size : cap) : nullptr;
+  if (size && !buf) { f.close(); return false; }
+
+  // 1) trailers de atrás hacia adelante. Ventana sin ningún trailer →
+  //    zona sin marcos: no se sigue. Lo anterior al bloque verificado no
+  //    se toca aunque no cuadre: /fs/view lo marca.
+  size_t   lastEnd = 0;       // fin del último trailer del archivo (absoluto)
+  uint32_t lastSeq = 0;
+  bool     anyTrailer = false;
+  size_t   good = 0;          // fin del último bloque que verifica
+  bool     verified = false;
+  size_t   bufAt = 0, bufLen = 0;     // qué parte del archivo hay en buf
+  for (size_t end = size; end > 0 && !verified; ) {
+    size_t win  = end < cap ? end : cap;
+    size_t base = end - win;
+    f.seek(base);
+    win = f.read(buf, win);
+    if (!win) break;
+    bufAt = base;
+    bufLen = win;
+    ri.scanned += win;
+
+    bool here = false;
+    size_t e = win;
+    while (e > 0 && !verified) {
+      // línea [ls, le) + '\n' en e-1
+      size_t le = e;
+      if (buf[le - 1] == '\n') --le;
+      size_t ls = le;
+      while (ls > 0 && buf[ls - 1] != '\n') --ls;
+      if (ls == 0 && base > 0) break;         // línea cortada: va en la próxima ventana
+
+      uint32_t seq, len, crc;
+      if (e - 1 == le && parseFrameTrailer((const char*)buf + ls, le - ls, &seq, &len, &crc)) {
+        here = true;
+        if (!anyTrailer) {
+          anyTrailer = true;
+          lastEnd = base + e;
+          lastSeq = seq + 1;
+        }
+        size_t at = base + ls;                // inicio del trailer (absoluto)
+        if (len <= at && len <= CLOGFS_FRAME_MAX) {
+          uint32_t c = 0;
+          uint8_t tmp[256];
+          f.seek(at - len);
+          size_t left = len;
+          while (left) {
+            int r = f.read(tmp, left < sizeof(tmp) ? left : sizeof(tmp));
+            if (r <= 0) break;
+            c = crc32(c, tmp, r);
+            left -= r;
+          }
+          ri.scanned += len;
+          if (!left && c == crc) { verified = true; good = base + e; }
+        }
+        if (!verified) ri.badFrames++;
+      }
+      e = ls;
+    }
+    if (!here || e == win) break;
+    end = base + e;
+  }
+
+  // 2) desde dónde se revisa: el bloque verificado; sin él, el último
+  //    trailer; sin trailers, la ventana final alineada a línea (o el
+  //    archivo entero si entra)
+  size_t tail;                // inicio de la cola sin cerrar (absoluto)
+  if (anyTrailer) {
+    tail = lastEnd;
+    if (!verified) { good = lastEnd; ri.badFrames = 0; }   // nada que comparar
+  } else {
+    tail = size > cap ? size - cap : 0;
+    if (tail) {
+      if (bufAt != tail || bufAt + bufLen != size) { f.seek(tail); bufAt = tail; bufLen = f.read(buf, size - tail); }
+      size_t p = 0;
+      while (p < bufLen && buf[p] != '\n') ++p;
+      if (p < bufLen) ++p;
+      tail += p;
+    }
+    good = tail;
+  }
+  ri.framed = verified && good == lastEnd;
+  if (bufAt > tail || bufAt + bufLen != size) {   // la cola ya no está en buf
+    f.seek(tail);
+    bufAt  = tail;
+    bufLen = f.read(buf, size - tail);
+  }
+  f.close();
+
+  size_t from = tail - bufAt;
+  size_t keep = 0;
+  for (size_t p = from; p < bufLen; ) {
+    const uint8_t* nl = (const uint8_t*)memchr(buf + p, '\n', bufLen - p);
+    if (!nl) break;                           // línea cortada
+    size_t end = (nl - buf) + 1;
+    bool ok = true;
+    for (size_t i = p; i < end && ok; ++i) ok = buf[i] != 0x00 && buf[i] != 0xFF;   // borrado / relleno
+    if (!ok) break;
+    keep += end - p;
+    p = end;
+  }
+  ri.kept    = keep;
+  ri.dropped = (uint32_t)((tail - good) + (bufLen - from - keep));
+
+  // 3) truncar la basura, dejar la marca y cerrar la cola con su trailer
+  //    (la marca queda dentro del bloque: un segundo mount no la re-enmarca).
+  //    Con bloques descartados la cola se corta en good y se reescribe.
+  //    Sólo se enmarca desde un borde de bloque: sin trailers, únicamente
+  //    si la cola es el archivo entero
+  char mark[40];
+  int  nm = !ri.dropped ? 0
+          : jsonl ? snprintf(mark, sizeof(mark), "{\"#X\":\"dropped=%lu\"}\r\n", (unsigned long)ri.dropped)
+                  : snprintf(mark, sizeof(mark), "#X dropped=%lu\r\n", (unsigned long)ri.dropped);
+  bool rewrite = tail > good && keep;
+  bool reframe = _framing && (keep || nm) && keep + nm <= CLOGFS_FRAME_MAX && (anyTrailer || good == 0);
+  bool ok = true;
+  if (ri.dropped) ok = truncateFile(full, tail > good ? good : good + keep);
+  if (ok && (reframe || nm)) {
+    File a = LittleFS.open(full, FILE_APPEND);
+    if (a) {
+      if (rewrite) a.write(buf + from, keep);
+      if (nm) a.write((const uint8_t*)mark, nm);
+      if (reframe) {
+        uint32_t c = crc32(crc32(0, buf + from, keep), mark, nm);
+        char t[40];
+        int n = jsonl ? snprintf(t, sizeof(t), "{\"#F\":\"%08lx %04lx %08lx\"}\r\n",
+                                 (unsigned long)lastSeq, (unsigned long)(keep + nm), (unsigned long)c)
+                      : snprintf(t, sizeof(t), "#F %08lx %04lx %08lx\r\n",
+                                 (unsigned long)lastSeq, (unsigned long)(keep + nm), (unsigned long)c);
+        a.write((const uint8_t*)t, n);
+      }
+      a.close();
+    }
+  }
+  free(buf);
+  ri.micros = micros() - t0;
+  if (info) *info = ri;
+  return ok;
+}
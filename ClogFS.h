@@ -5,6 +5,33 @@
 #include <Arduino.h>
 #include <FS.h>
 #include <LittleFS.h>
+#include <vector>
+#include "StageRing.h"
+
+#ifndef CLOGFS_SAMPLE_SITES
+#define CLOGFS_SAMPLE_SITES 8     // sitios con muestreo configurables
+#endif
+#ifndef CLOGFS_CHANNELS
+#define CLOGFS_CHANNELS     4     // canales de log con nombre (incluye "log")
+#endif
+#if CLOGFS_CHANNELS > 16
+#error "CLOGFS_CHANNELS: la caché reciente guarda el canal en 4 bits"
+#endif
+#ifndef CLOGFS_BUSY_WINDOW_US
+#define CLOGFS_BUSY_WINDOW_US 500000  // sin staging: ventana de ocupación de la flash
+#endif
+#ifndef CLOGFS_FRAME_BYTES
+#define CLOGFS_FRAME_BYTES  1024  // trailer cada ~N bytes de un canal
+#endif
+#ifndef CLOGFS_FRAME_MS
+#define CLOGFS_FRAME_MS     60000 // bloque abierto más viejo que esto: lo cierra loop()
+#endif
+#ifndef CLOGFS_FRAME_MAX
+#define CLOGFS_FRAME_MAX    16384 // tope de un bloque (y de la ventana de recuperación)
+#endif
+#if CLOGFS_FRAME_MAX > 0xFFFF
+#error "CLOGFS_FRAME_MAX: el largo del trailer tiene 4 dígitos hex"
+#endif
 
 class ClogFS {
 public:
@@ -17,6 +44,49 @@ public:
   LVL_SERIAL_AND_LOG = 3
 };
 
+  // formato de salida por destino
+  enum Format : uint8_t { FMT_TEXT = 0, FMT_JSONL = 1 };
+
+  // fmt → nombre/ID del catálogo (p.ej. Msg::nameOf); nullptr si no está
+  typedef const char* (*MsgNameFn)(const __FlashStringHelper* fmt, int* id);
+
+
+  // manifest: una entrada por archivo de log (segmento) en la base
+  struct Segment {
+    char     name[32];
+    uint32_t size;
+    uint32_t first, last;   // epoch de primera/última línea (0 = sin hora)
+    uint16_t sevCount[6];   // líneas por severidad
+  };
+
+  // resultado de recoverTail()
+  struct RecoverInfo {
+    uint32_t scanned;      // bytes leídos (cola + verificación del último bloque)
+    uint32_t kept;         // cola sin trailer con líneas sanas, re-enmarcada
+    uint32_t dropped;      // basura / línea cortada / bloques sin CRC válido, truncado
+    uint32_t badFrames;    // bloques del final descartados por CRC
+    uint32_t micros;
+    bool     framed;       // el último bloque cerrado verifica su CRC
+  };
+
+  // staging (ver enableStaging)
+  struct StageStats {
+    size_t   capacity, used, peakUsed;
+    bool     inPsram;
+    uint32_t stalls, dropped;     // backpressure / líneas descartadas
+    uint64_t ingested, drained;   // bytes
+    uint32_t avgBps, peakBps;     // sostenido desde enable / pico en ventana de 1 s
+  };
+
+  // muestreo por sitio: la clave es el puntero del formato
+  // (p.ej. Msg::BME280_LINE()); seen/written se reinician en cada resumen
+  struct SampleSite {
+    const __FlashStringHelper* fmt;
+    uint16_t every;        // 1 de cada N (0/1 = todos)
+    uint32_t intervalMs;   // a lo sumo 1 cada intervalMs (0 = sin límite)
+    uint32_t lastMs;
+    uint32_t seen, written;
+  };
 
   ClogFS();
 
@@ -25,20 +95,38 @@ public:
   void setBootBufferCapacityBytes(size_t cap);
   void setFsLowWater(size_t bytes);
   void setBasePath(const char* p);
+  // prefijo VFS de LittleFS.begin() (default "/littlefs"); lo usa el
+  // truncado de recoverTail(), que va por POSIX
+  void setMountPoint(const char* vfs);
+
+  // JSON Lines: un objeto por línea con ts ISO, sev, id/nombre del
+  // catálogo y argumentos tipados. El de archivo aplica desde el próximo
+  // open/rotate (no se mezclan formatos dentro de un archivo).
+  void setSerialFormat(Format f) { _serialFmt = f; }
+  void setFileFormat(Format f)   { _fileFmt = f; }
+  Format serialFormat() const { return _serialFmt; }
+  Format fileFormat()   const { return _fileFmt; }
+  const char* fileExt() const { return _fileFmt == FMT_JSONL ? ".jsonl" : ".txt"; }
+  void setMsgNameResolver(MsgNameFn fn) { _nameFn = fn; }
 
-  // severidad (umbral)
+  // severidad (umbral del canal 0)
   void setMinSeverity(Severity s);
-  Severity minSeverity() const { return _minSev; }
+  Severity minSeverity() const { return _chan[0].minSev; }
   static const char* sevName(Severity s);
+  static bool sevFromName(const char* name, Severity* out);
 
-  // open/rotate/close
+  // open/rotate/close (archivo del canal 0; rotate/close cierran también
+  // los demás canales, que se reabren solos con la próxima línea)
   bool openFile(const char* filename, const char* header_ascii=nullptr);
   bool rotate(const String& newFilename, const char* header_ascii=nullptr);
   bool rotateDailyIfNeeded(const char* header_ascii=nullptr);
   void closeFile();
   void resetDayTracking();
+  bool fileOpen() const { return _sink[0].ok; }
+  const String& currentPath() const { return _sink[0].path; }
+  bool isOpenFile(const char* name) const;          // activo de algún canal
 
-  // API de log (msg == info)
+  // API de log (msg == info), canal 0
   void msg  (const __FlashStringHelper *fmt, ...);
   void trace(const __FlashStringHelper *fmt, ...);
   void debug(const __FlashStringHelper *fmt, ...);
@@ -46,38 +134,230 @@ public:
   void warn (const __FlashStringHelper *fmt, ...);
   void error(const __FlashStringHelper *fmt, ...);
   void crit (const __FlashStringHelper *fmt, ...);
+  void log  (uint8_t ch, Severity sev, const __FlashStringHelper *fmt, ...);
+
+  // canales con nombre: archivos propios "<nombre>-YYYYMMDD-HHMMSS.txt",
+  // umbral, rotación por tamaño y cuota de retención. Comparten el boot
+  // buffer, el staging (una sola tarea escribe todo) y el presupuesto de
+  // flash. El canal 0 es "log": la API de siempre.
+  int  addChannel(const char* name, Severity minSev = INFO, uint32_t quotaBytes = 0, uint32_t maxFileBytes = 0);
+  int  channel(const char* name) const;
+  size_t      channelCount() const { return _nChan; }
+  const char* channelName(size_t i) const { return _chan[i].name; }
+  Severity    channelMinSeverity(size_t i) const { return _chan[i].minSev; }
+  uint32_t    channelQuota(size_t i) const { return _chan[i].quota; }
+  uint32_t    channelMaxFile(size_t i) const { return _chan[i].maxFile; }
+  uint32_t    channelBytes(size_t i) const;          // suma de sus segmentos
+  void setChannelMinSeverity(uint8_t ch, Severity s);
+  // el canal 0 rota sólo con rotate()/rotateDailyIfNeeded() (nombre y
+  // cabecera los da el llamador): maxFileBytes ahí se rechaza (false)
+  bool setChannelQuota(uint8_t ch, uint32_t quotaBytes, uint32_t maxFileBytes = 0);
+  int  channelOfFile(const char* name) const;        // por prefijo; -1 = ninguno
+
+  // presupuesto de todos los canales juntos (0 = sólo low-water): al
+  // pasarlo se borran los segmentos cerrados más viejos de cualquier canal
+  void setFlashBudget(uint32_t bytes) { _budget = bytes; }
+  uint32_t flashBudget() const { return _budget; }
 
   // utilidades 
   void listDir(const char* path);
-  static String makeFilename(time_t epoch);
+  static String makeFilename(time_t epoch, const char* ext = ".txt", const char* prefix = "log");
 
   // FS
   size_t fsFreeBytes() const;
   bool wipeAllInBasePath();
   bool reopenFreshFileAfterWipe(const char* header_ascii=nullptr);
 
+  // manifest (RAM + <base>/.clogfs.idx). Se arma en el mount y se
+  // actualiza en write/rotate/delete; listados y web no tocan el FS.
+  bool mountManifest();
+  bool saveManifest();
+  bool manifestReady() const { return _manifestOk; }
+  size_t segmentCount() const { return _segs.size(); }
+  const Segment& segment(size_t i) const { return _segs[i]; }
+  const Segment* findSegment(const char* name) const;
+  bool removeSegment(const char* name);
+  static const char* manifestName() { return ".clogfs.idx"; }
+
+  // staging: buffer grande (PSRAM si hay) que absorbe ráfagas; una tarea
+  // lo vacía a LittleFS en bloques de blockBytes. Si el llenado supera
+  // highPct el llamador espera hasta bajar a lowPct (backpressure).
+  bool enableStaging(size_t bytes, size_t blockBytes=4096, uint8_t highPct=90, uint8_t lowPct=50);
+  void disableStaging();
+  void flushStaging();
+  bool stagingEnabled() const { return _stage.capacity() > 0; }
+  StageStats stagingStats() const;
+
+  // muestreo por sitio (TRACE/DEBUG de alta frecuencia). Si el evento
+  // se descarta no se formatea nada.
+  bool sampleEvery(const __FlashStringHelper* fmt, uint16_t n);
+  bool sampleInterval(const __FlashStringHelper* fmt, uint32_t ms);
+  void clearSampling(const __FlashStringHelper* fmt);
+  void setSampleSummaryPeriod(uint32_t ms) { _sampleSummaryMs = ms; }
+  size_t sampleSiteCount() const { return _nSites; }
+  const SampleSite& sampleSite(size_t i) const { return _sites[i]; }
+
+  // caché en RAM de las últimas líneas (todas las salidas, con severidad).
+  // Se lee sin tocar LittleFS; 0 = desactivada.
+  bool setRecentCacheBytes(size_t bytes);
+  size_t recentCacheBytes() const { return _recent.capacity(); }
+  // trunc: el registro era más largo que lo que se entrega (255 bytes)
+  typedef void (*RecentFn)(void* ctx, Severity sev, const char* line, size_t len, bool trunc);
+  size_t forEachRecent(Severity minSev, size_t maxLines, RecentFn fn, void* ctx, int ch = -1) const;
+  // lectura en tramos (web): posiciones absolutas en la caché, que siguen
+  // valiendo cuando se descartan los registros viejos (esos se saltean).
+  // recentOpen fija el rango: las últimas maxLines que pasan el filtro,
+  // hasta lo escrito ahora. recentNext entrega una línea y avanza
+  struct RecentCursor {
+    uint32_t pos, end;
+    uint8_t  minSev;
+    int8_t   ch;
+  };
+  void recentOpen(RecentCursor& rc, Severity minSev, size_t maxLines, int ch = -1) const;
+  bool recentNext(RecentCursor& rc, char* line, size_t cap, size_t* len, Severity* sev, bool* trunc) const;
+
+  // admisión bajo sobrecarga: con el buffer interno (staging, o boot
+  // buffer sin archivo) sobre cada marca se descarta TRACE, luego DEBUG,
+  // luego INFO. Sin staging y con archivo, el "llenado" es el % del tiempo
+  // bloqueado en la flash en la última ventana (CLOGFS_BUSY_WINDOW_US).
+  // WARN/ERROR/CRIT nunca se descartan y usan la reserva.
+  void setShedWatermarks(uint8_t tracePct, uint8_t debugPct, uint8_t infoPct);
+  void setCritFlush(bool on) { _critFlush = on; }     // CRIT → flush síncrono
+  void setShedSummaryPeriod(uint32_t ms) { _shedSummaryMs = ms; }
+  uint32_t shedCount(Severity s) const { return (s <= CRIT) ? _shed[s] : 0; }
+  uint8_t  bufferFillPct() const;
+
+  // bloques enmarcados: cada ~CLOGFS_FRAME_BYTES de un canal (o un CRIT,
+  // o CLOGFS_FRAME_MS de bloque abierto) se cierran con una línea trailer
+  //   #F <seq> <len> <crc32>          (JSONL: {"#F":"<seq> <len> <crc32>"})
+  // que cubre los len bytes anteriores. En el mount se busca el último
+  // trailer cuyo CRC verifica desde el final: el costo es un bloque (más
+  // los dañados al final), no el archivo.
+  void setFraming(bool on) { _framing = on; }
+  bool framing() const { return _framing; }
+  bool recoverTail(const char* path, RecoverInfo* info = nullptr);
+  static uint32_t crc32(uint32_t crc, const void* data, size_t n);
+  static bool parseFrameTrailer(const char* line, size_t n, uint32_t* seq, uint32_t* len, uint32_t* crc);
+
+  // tareas periódicas (resúmenes); llamar desde loop()
+  void loop();
+
   void setLevel(Level lv) { _level = lv; }
   Level level() const { return _level; }
 
 private:
-  void vmsg_(Severity sev, const __FlashStringHelper *fmt, va_list ap);
-  void writeLineASCII(const char* line);
+  struct Chan {
+    char     name[10];       // prefijo de sus archivos (entra en Segment::name)
+    Severity minSev;
+    uint32_t quota;          // bytes de todos sus segmentos (0 = sin límite)
+    uint32_t maxFile;        // rotación por tamaño (0 = sólo diaria)
+  };
+  struct Sink {              // archivo abierto de un canal
+    File     file;
+    bool     ok, ready;
+    String   path;
+    Format   fmt;
+    int      seg;            // índice en _segs (-1 = fuera del manifest)
+    uint32_t frameSeq, frameLen, frameCrc;
+    uint32_t frameT0;        // millis() del primer byte del bloque abierto
+  };
+
+  void vmsg_(uint8_t ch, Severity sev, const __FlashStringHelper *fmt, va_list ap, bool force = false);
+  void notice(Severity sev, const __FlashStringHelper *fmt, ...);
+  void writeBusy(uint32_t t0);
+  void writeLine(uint8_t ch, const char* line, Severity sev, const char* bootLine);
+  void writeHeader(Sink& s, const char* header_ascii);
+  bool openSink(uint8_t ch, const String& fullPath, const char* header_ascii);
+  void closeSink(Sink& s);
+  Sink* sinkFor(uint8_t ch);
+  size_t fileWrite(Sink& s, const void* data, size_t n);
+  void frameRoom(Sink& s, size_t n);
+  void frameClose(Sink& s);
+  bool truncateFile(const String& fullPath, size_t len);
+  size_t buildJson(char* out, size_t cap, uint8_t ch, Severity sev, const __FlashStringHelper* fmt,
+                   va_list ap, const char* msg);
   void flushBootBufferToFile();
   void bootBufAppendLine(const char* line);
   bool buildTimePrefix(char* ts, size_t ts_len);
 
-  File   _file;
-  bool   _fileOk, _fileReady;
+  String fullPathOf(const char* name) const;
+  int  segIndex(const char* name) const;
+  void segOpened(Sink& s, const String& fullPath);
+  void segAppend(int seg, size_t bytes, int sev);
+  void segAppendBlock(int seg, const char* text, size_t len);
+  int  oldestSegment(int ch) const;
+  void enforceRetention();
+  bool retentionActive() const;      // presupuesto o alguna cuota
+  bool reclaim(size_t need);
+
+  void recentAppend(uint8_t ch, Severity sev, const char* line);
+
+  bool admit(Severity sev);
+
+  SampleSite* sampleSiteFor(const __FlashStringHelper* fmt, bool create);
+  bool sampleAdmit(const __FlashStringHelper* fmt);
+  void sampleSummary();
+
+  void   stagePush(uint8_t ch, const char* line, Severity sev);
+  size_t stageDrainOnce();
+  void   stageKick();
+  bool   drainingHere() const;
+  void   lockFile();
+  void   unlockFile();
+#if defined(ARDUINO_ARCH_ESP32)
+  static void stageTask(void* arg);
+#endif
+
+  Chan   _chan[CLOGFS_CHANNELS];
+  Sink   _sink[CLOGFS_CHANNELS];
+  uint8_t  _nChan;
+  uint32_t _budget, _retainT0;
   time_t (*_nowFn)();
   String _bootBuf;
   size_t _bootCap;
   int    _lastDay;
   size_t _fsLowWater;
   String _basePath;
-  String _currentPath;
-  Severity _minSev;
+  String _mountPoint;
 
   Level _level;
+  Format _serialFmt, _fileFmt;
+  MsgNameFn _nameFn;
+
+  bool     _framing;
+
+  std::vector<Segment> _segs;
+  bool   _manifestOk;
+
+  SampleSite _sites[CLOGFS_SAMPLE_SITES];
+  uint8_t    _nSites;
+  uint32_t   _sampleSummaryMs, _sampleSummaryT0;
+
+  uint8_t  _shedPct[3];           // TRACE, DEBUG, INFO
+  bool     _critFlush;
+  uint32_t _shed[6], _shedPeriod[6];
+  uint32_t _shedSummaryMs, _shedSummaryT0;
+  uint32_t _wrWinT0, _wrBusyUs;   // escritura directa: ventana de ocupación
+  uint8_t  _wrBusyPct;
+
+  StageRing _recent;     // registros [sev | canal<<4][len lo][len hi][texto]
+  uint32_t  _recentBase; // posición absoluta del registro más viejo
+
+  StageRing _stage;      // registros [canal][sev][len lo][len hi][línea\r\n]
+  uint8_t*  _drainBuf;   // 2 bloques: registros leídos + líneas de un canal
+  size_t    _stageBlock, _stageHigh, _stageLow, _stagePeak;
+  bool      _stagePsram, _inDrain;
+  // contadores: se escriben y se leen bajo _stageMux (productores y la
+  // tarea de vaciado corren en núcleos distintos)
+  uint32_t  _stageStalls, _stageDropped;
+  uint64_t  _stageIn, _stageOut;
+  uint32_t  _stageT0, _rateWinT0, _rateWinBytes, _ratePeak;
+#if defined(ARDUINO_ARCH_ESP32)
+  mutable portMUX_TYPE _stageMux;
+  SemaphoreHandle_t _fileMux;
+  TaskHandle_t      _stageTaskH;
+  TaskHandle_t      _drainOwner;   // tarea dentro de stageDrainOnce()
+#endif
 
 };
 
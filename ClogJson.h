@@ -0,0 +1,98 @@
+// ClogJson.h — escritor JSON mínimo para la salida JSON Lines de ClogFS.
+// Escribe directo sobre un buffer del llamador: sin heap, sin String.
+// Si algo no entra queda overflow() = true y el contenido ya no sirve
+// (el llamador decide qué hacer; ClogFS arma un registro reducido).
+#ifndef CLOG_JSON_H
+#define CLOG_JSON_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+class JsonWriter {
+public:
+  JsonWriter(char* buf, size_t cap) : _buf(buf), _cap(cap), _len(0), _ovf(cap == 0) { term(); }
+
+  void reset() { _len = 0; _ovf = (_cap == 0); term(); }
+
+  // texto tal cual (estructura: llaves, comas, claves ya válidas)
+  JsonWriter& raw(const char* s, size_t n) {
+    if (_ovf) return *this;
+    if (_len + n + 1 > _cap) { _ovf = true; return *this; }
+    memcpy(_buf + _len, s, n);
+    _len += n;
+    term();
+    return *this;
+  }
+  JsonWriter& raw(const char* s) { return raw(s, strlen(s)); }
+  JsonWriter& ch(char c) { return raw(&c, 1); }
+
+  // "texto" con escape: \" \\ y controles como \n \t o \u00XX.
+  // UTF-8 pasa sin tocar (JSON lo admite).
+  JsonWriter& str(const char* s, size_t n) {
+    static const char hex[] = "0123456789abcdef";
+    ch('"');
+    for (size_t i = 0; i < n && !_ovf; ++i) {
+      unsigned char c = (unsigned char)s[i];
+      switch (c) {
+        case '"':  raw("\\\"", 2); break;
+        case '\\': raw("\\\\", 2); break;
+        case '\n': raw("\\n", 2);  break;
+        case '\r': raw("\\r", 2);  break;
+        case '\t': raw("\\t", 2);  break;
+        default:
+          if (c < 0x20) {
+            char u[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 15] };
+            raw(u, 6);
+          } else {
+            ch((char)c);
+          }
+      }
+    }
+    return ch('"');
+  }
+  JsonWriter& str(const char* s) { return s ? str(s, strlen(s)) : raw("null", 4); }
+
+  // ,"clave": (coma salvo justo después de '{' o '[')
+  JsonWriter& key(const char* k) { comma(); str(k); return ch(':'); }
+  JsonWriter& comma() {
+    if (_len && _buf[_len - 1] != '{' && _buf[_len - 1] != '[') ch(',');
+    return *this;
+  }
+
+  JsonWriter& i64(int64_t v) {
+    char t[24];
+    int n = snprintf(t, sizeof(t), "%lld", (long long)v);
+    return raw(t, (size_t)n);
+  }
+  JsonWriter& u64(uint64_t v) {
+    char t[24];
+    int n = snprintf(t, sizeof(t), "%llu", (unsigned long long)v);
+    return raw(t, (size_t)n);
+  }
+  // prec < 0 → %g; NaN/Inf no existen en JSON → null
+  JsonWriter& f64(double v, int prec = -1) {
+    if (isnan(v) || isinf(v)) return raw("null", 4);
+    char t[32];
+    int n = (prec >= 0) ? snprintf(t, sizeof(t), "%.*f", prec > 9 ? 9 : prec, v)
+                        : snprintf(t, sizeof(t), "%g", v);
+    if (n < 0 || n >= (int)sizeof(t)) return raw("null", 4);
+    return raw(t, (size_t)n);
+  }
+  JsonWriter& boolean(bool b) { return b ? raw("true", 4) : raw("false", 5); }
+
+  size_t      length()   const { return _len; }
+  bool        overflow() const { return _ovf; }
+  const char* c_str()    const { return _buf; }
+
+private:
+  void term() { if (_cap) _buf[_len < _cap ? _len : _cap - 1] = 0; }
+
+  char*  _buf;
+  size_t _cap, _len;
+  bool   _ovf;
+};
+
+#endif // CLOG_JSON_H
@@ -0,0 +1,488 @@
+#include "ClogTS.h"
+#include <cctype>
+#include <cstring>
+#include <cmath>
+#include <vector>
+
+static const uint16_t BLOCK_MAGIC = 0x3354;           // "T3": ch = huella del nombre
+static const uint32_t MIN_VALID_EPOCH = 1600000000;   // sin hora válida → descarta
+static const uint32_t SPAN[2] = { 60, 3600 };         // RES_MIN, RES_HOUR
+
+ClogTS::ClogTS()
+: _nowFn(nullptr),
+  _basePath("/ts/"),
+  _keepRaw(7), _keepMin(7), _keepHour(12),
+  _ready(false),
+  _ch(), _nCh(0),
+  _flushT0(0),
+  _pruneDay(-1)
+{}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// config
+// ─────────────────────────────────────────────────────────────────────────────
+void ClogTS::setTimeProvider(time_t (*nowFn)()){ _nowFn = nowFn; }
+
+void ClogTS::setBasePath(const char* p){
+  _basePath = (p && *p) ? String(p) : String("/ts/");
+  if (!_basePath.startsWith("/")) _basePath = String("/") + _basePath;
+  if (!_basePath.endsWith("/"))   _basePath += "/";
+}
+
+// días de crudo y de minutos, meses de horas
+void ClogTS::setRetention(uint16_t rawDays, uint16_t minDays, uint16_t hourMonths){
+  _keepRaw  = rawDays  ? rawDays  : 1;
+  _keepMin  = minDays  ? minDays  : 1;
+  _keepHour = hourMonths ? hourMonths : 1;
+}
+
+bool ClogTS::begin(){
+  String dir = _basePath.substring(0, _basePath.length() - 1);
+  if (dir.length() && !LittleFS.exists(dir)) LittleFS.mkdir(dir.c_str());
+  _ready = true;
+  _flushT0 = millis();
+  return true;
+}
+
+const char* ClogTS::resName(Res r){
+  switch (r) {
+    case RES_RAW:  return "raw";
+    case RES_MIN:  return "1m";
+    case RES_HOUR: return "1h";
+  }
+  return "?";
+}
+
+bool ClogTS::resFromName(const char* s, Res* out){
+  if (!s) return false;
+  for (int r = RES_RAW; r <= RES_HOUR; ++r) {
+    if (strcmp(s, resName((Res)r)) == 0) { *out = (Res)r; return true; }
+  }
+  return false;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// canales
+// ─────────────────────────────────────────────────────────────────────────────
+int ClogTS::addChannel(const char* name, float scale){
+  if (!name || !*name || strlen(name) >= sizeof(Chan::name) || !(scale > 0)) return -1;
+  for (const char* p = name; *p; ++p) {         // van tal cual a JSON / CSV
+    if (!isalnum((unsigned char)*p) && !strchr("_.-", *p)) return -1;
+  }
+  int i = channel(name);
+  if (i >= 0) return i;
+  if (_nCh >= CLOGTS_CHANNELS) return -1;
+  Chan& c = _ch[_nCh];
+  memset(&c, 0, sizeof(c));
+  strncpy(c.name, name, sizeof(c.name) - 1);
+  c.tag   = nameTag(c.name);
+  c.scale = scale;
+  c.day   = -1;
+  return _nCh++;
+}
+
+// FNV-1a plegado a 8 bits: los archivos ya van por nombre, la huella
+// sólo descarta registros de otro canal (archivo copiado o renombrado)
+uint8_t ClogTS::nameTag(const char* name){
+  uint32_t h = 2166136261u;
+  for (const char* p = name; *p; ++p) { h ^= (uint8_t)*p; h *= 16777619u; }
+  h ^= h >> 16;
+  return (uint8_t)(h ^ (h >> 8));
+}
+
+int ClogTS::channel(const char* name) const {
+  if (!name) return -1;
+  for (uint8_t i = 0; i < _nCh; ++i) {
+    if (strcmp(_ch[i].name, name) == 0) return i;
+  }
+  return -1;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// escritura
+// ─────────────────────────────────────────────────────────────────────────────
+bool ClogTS::record(int ch, float value){
+  time_t t = _nowFn ? _nowFn() : time(nullptr);
+  return record(ch, value, t);
+}
+
+bool ClogTS::record(int ch, float value, time_t t){
+  if (!_ready || ch < 0 || ch >= _nCh || std::isnan(value) || std::isinf(value)) return false;
+  if (t < (time_t)MIN_VALID_EPOCH) return false;
+  Chan& c = _ch[ch];
+
+  double q = round((double)value / c.scale);
+  if (q > 2147483647.0)  q = 2147483647.0;
+  if (q < -2147483648.0) q = -2147483648.0;
+  int32_t v  = (int32_t)q;
+  uint32_t ut = (uint32_t)t;
+
+  struct tm* tm_info = localtime(&t);
+  int day = tm_info ? (tm_info->tm_year * 400 + tm_info->tm_yday) : 0;
+
+  // el bloque no cruza de día (archivo), no retrocede y tiene lugar
+  // para el peor caso (2 varints de 5 bytes)
+  if (c.hdr.count && (day != c.day || ut < c.lastT || c.hdr.count == 0xFFFF ||
+                      c.hdr.len + 10 > CLOGTS_BLOCK_BYTES)) {
+    flushBlock(ch);
+  }
+  if (!c.hdr.count) {
+    c.hdr.magic = BLOCK_MAGIC;
+    c.hdr.ch    = c.tag;
+    c.hdr.flags = 0;
+    c.hdr.count = 1;
+    c.hdr.len   = 0;
+    c.hdr.t0    = ut;
+    c.hdr.v0    = v;
+    c.day       = day;
+  } else {
+    c.hdr.len += putVar(c.buf + c.hdr.len, (int32_t)(ut - c.lastT));
+    c.hdr.len += putVar(c.buf + c.hdr.len, (int32_t)((int64_t)v - c.lastV));
+    c.hdr.count++;
+  }
+  c.lastT = ut;
+  c.lastV = v;
+  c.samples++;
+
+  accAdd(ch, 0, ut, v);
+  accAdd(ch, 1, ut, v);
+  return true;
+}
+
+void ClogTS::flush(){
+  for (uint8_t i = 0; i < _nCh; ++i) flushBlock(i);
+  _flushT0 = millis();
+}
+
+void ClogTS::loop(){
+  if (!_ready) return;
+  time_t now = _nowFn ? _nowFn() : time(nullptr);
+
+  if (now >= (time_t)MIN_VALID_EPOCH) {
+    // minutos/horas vencidos aunque el canal no reciba más muestras
+    for (uint8_t i = 0; i < _nCh; ++i) {
+      for (int r = 0; r < 2; ++r) {
+        const Acc& a = _ch[i].acc[r];
+        if (a.n && (uint32_t)now >= a.t + SPAN[r]) accEmit(i, r);
+      }
+    }
+    struct tm* tm_info = localtime(&now);
+    if (tm_info && tm_info->tm_yday != _pruneDay) {
+      _pruneDay = tm_info->tm_yday;
+      prune();
+    }
+  }
+
+  if (millis() - _flushT0 > CLOGTS_FLUSH_MS) flush();
+}
+
+void ClogTS::flushBlock(int ch){
+  Chan& c = _ch[ch];
+  if (!c.hdr.count) return;
+  c.hdr.t1 = c.lastT;
+  append(pathFor(0, (time_t)c.hdr.t0, ch), &c.hdr, sizeof(c.hdr), c.buf, c.hdr.len);
+  c.hdr.count = 0;
+  c.hdr.len   = 0;
+}
+
+void ClogTS::accAdd(int ch, int r, uint32_t t, int32_t v){
+  Acc& a = _ch[ch].acc[r];
+  uint32_t b = bucketOf(t, r);
+  if (a.n && (a.t != b || a.n == 0xFFFF)) accEmit(ch, r);
+  if (!a.n) {
+    a.t = b; a.min = a.max = v; a.sum = 0;
+  }
+  if (v < a.min) a.min = v;
+  if (v > a.max) a.max = v;
+  a.sum += v;
+  a.n++;
+}
+
+void ClogTS::accEmit(int ch, int r){
+  Acc& a = _ch[ch].acc[r];
+  if (!a.n) return;
+  Rollup ru;
+  ru.t   = a.t;
+  ru.ch  = _ch[ch].tag;
+  ru.res = (uint8_t)(r + 1);
+  ru.n   = a.n;
+  ru.min = a.min;
+  ru.max = a.max;
+  ru.avg = (int32_t)llround((double)a.sum / a.n);
+  append(pathFor((uint8_t)(r + 1), (time_t)a.t, ch), &ru, sizeof(ru));
+  a.n = 0;
+}
+
+// sin lugar: borra el archivo más viejo (crudo primero) y reintenta una vez
+bool ClogTS::append(const String& path, const void* a, size_t na, const void* b, size_t nb){
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    File f = LittleFS.open(path, FILE_APPEND);
+    if (f) {
+      bool ok = f.write((const uint8_t*)a, na) == na &&
+                (!nb || f.write((const uint8_t*)b, nb) == nb);
+      f.close();
+      if (ok) return true;
+    }
+    if (!pruneOldest()) break;
+  }
+  return false;
+}
+
+// kind: 0 raw-<canal>-YYYYMMDD, 1 m1-<canal>-YYYYMMDD, 2 h1-<canal>-YYYYMM
+// (fecha local). Todo va por nombre de canal: una consulta lee sólo lo
+// suyo y el orden de addChannel entre arranques no mezcla series
+String ClogTS::pathFor(uint8_t kind, time_t t, int ch) const {
+  struct tm* tm_info = localtime(&t);
+  char name[64];
+  if (!tm_info) return _basePath + "invalid.bin";
+  const char* cn = _ch[ch].name;
+  if (kind == 2)      snprintf(name, sizeof(name), "h1-%s-%04d%02d.bin", cn,
+                               tm_info->tm_year + 1900, tm_info->tm_mon + 1);
+  else if (kind == 1) snprintf(name, sizeof(name), "m1-%s-%04d%02d%02d.bin", cn,
+                               tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday);
+  else                snprintf(name, sizeof(name), "raw-%s-%04d%02d%02d.bin", cn,
+                               tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday);
+  return _basePath + name;
+}
+
+// fecha de un nombre "<tipo>[-<canal>]-YYYYMMDD.bin": lo que sigue al último '-'
+static const char* dateOf(const char* name){
+  const char* d = strrchr(name, '-');
+  return d ? d + 1 : name;
+}
+
+// retención por nombre: fecha < corte → fuera
+void ClogTS::prune(){
+  time_t now = _nowFn ? _nowFn() : time(nullptr);
+  if (now < (time_t)MIN_VALID_EPOCH) return;
+
+  char cutRaw[40], cutMin[40], cutHour[40];
+  time_t tr = now - (time_t)_keepRaw * 86400;
+  time_t tn = now - (time_t)_keepMin * 86400;
+  struct tm* ti = localtime(&tr);
+  snprintf(cutRaw, sizeof(cutRaw), "%04d%02d%02d", ti->tm_year + 1900, ti->tm_mon + 1, ti->tm_mday);
+  ti = localtime(&tn);
+  snprintf(cutMin, sizeof(cutMin), "%04d%02d%02d", ti->tm_year + 1900, ti->tm_mon + 1, ti->tm_mday);
+  ti = localtime(&now);
+  int months = (ti->tm_year + 1900) * 12 + ti->tm_mon - _keepHour;
+  snprintf(cutHour, sizeof(cutHour), "%04d%02d", months / 12, months % 12 + 1);
+
+  String dirPath = _basePath.substring(0, _basePath.length() - 1);
+  File dir = LittleFS.open(dirPath.length() ? dirPath.c_str() : "/", FILE_READ);
+  if (!dir || !dir.isDirectory()) return;
+  std::vector<String> doomed;
+  for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+    String name = f.name();
+    name = name.substring(name.lastIndexOf('/') + 1);
+    f.close();
+    const char* n = name.c_str();
+    if      (strncmp(n, "raw-", 4) == 0 && strncmp(dateOf(n), cutRaw, 8) < 0)  doomed.push_back(name);
+    else if (strncmp(n, "m1-", 3) == 0  && strncmp(dateOf(n), cutMin, 8) < 0)  doomed.push_back(name);
+    else if (strncmp(n, "h1-", 3) == 0  && strncmp(dateOf(n), cutHour, 6) < 0) doomed.push_back(name);
+  }
+  dir.close();
+  for (const auto& n : doomed) LittleFS.remove(_basePath + n);
+}
+
+bool ClogTS::pruneOldest(){
+  String dirPath = _basePath.substring(0, _basePath.length() - 1);
+  File dir = LittleFS.open(dirPath.length() ? dirPath.c_str() : "/", FILE_READ);
+  if (!dir || !dir.isDirectory()) return false;
+  String oldRaw, oldMin;
+  for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+    String name = f.name();
+    name = name.substring(name.lastIndexOf('/') + 1);
+    f.close();
+    if (name.startsWith("raw-") && (oldRaw.isEmpty() || strcmp(dateOf(name.c_str()), dateOf(oldRaw.c_str())) < 0)) oldRaw = name;
+    if (name.startsWith("m1-")  && (oldMin.isEmpty() || strcmp(dateOf(name.c_str()), dateOf(oldMin.c_str())) < 0)) oldMin = name;
+  }
+  dir.close();
+  String victim = oldRaw.length() ? oldRaw : oldMin;   // las horas no se tocan
+  return victim.length() && LittleFS.remove(_basePath + victim);
+}
+
+// zigzag + LEB128
+size_t ClogTS::putVar(uint8_t* p, int32_t v){
+  uint32_t z = ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+  size_t n = 0;
+  while (z >= 0x80) { p[n++] = (uint8_t)(z | 0x80); z >>= 7; }
+  p[n++] = (uint8_t)z;
+  return n;
+}
+
+bool ClogTS::getVar(const uint8_t* p, uint16_t& pos, uint16_t end, int32_t& v){
+  uint32_t z = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (pos >= end) return false;
+    uint8_t b = p[pos++];
+    z |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) { v = (int32_t)((z >> 1) ^ (~(z & 1) + 1)); return true; }
+  }
+  return false;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// lectura
+// ─────────────────────────────────────────────────────────────────────────────
+bool ClogTS::open(Cursor& c, int ch, Res res, time_t from, time_t to){
+  if (c.f) c.f.close();
+  c.done = true;
+  if (!_ready || ch < 0 || ch >= _nCh) return false;
+
+  // fuera de la retención no hay archivos: no recorrer días vacíos
+  time_t now = _nowFn ? _nowFn() : time(nullptr);
+  if (now >= (time_t)MIN_VALID_EPOCH) {
+    uint32_t keepDays = (res == RES_RAW) ? _keepRaw : (res == RES_MIN) ? _keepMin : _keepHour * 31u;
+    time_t oldest = now - (time_t)(keepDays + 1) * 86400;
+    if (from < oldest)      from = oldest;
+    if (to > now + 86400)   to   = now + 86400;
+  }
+  if (to < from) return false;
+  c.ch    = (uint8_t)ch;
+  c.res   = (uint8_t)res;
+  c.from  = (uint32_t)(from > 0 ? from : 0);
+  c.to    = (uint32_t)to;
+  c.fileT = from;
+  c.done  = false;
+  c.live  = false;
+  c.left  = 0;
+  return true;
+}
+
+void ClogTS::close(Cursor& c){
+  if (c.f) c.f.close();
+  c.done = true;
+}
+
+bool ClogTS::next(Cursor& c, Point& p){
+  if (c.done) return false;
+  bool ok = (c.res == RES_RAW) ? nextRaw(c, p) : nextRollup(c, p);
+  if (!ok) close(c);
+  return ok;
+}
+
+// siguiente día (o mes para horas) a las 00:00 locales
+void ClogTS::advanceFile(Cursor& c){
+  if (c.f) c.f.close();
+  struct tm tmv = *localtime(&c.fileT);
+  if (c.res == RES_HOUR) { tmv.tm_mon++; tmv.tm_mday = 1; }
+  else                   { tmv.tm_mday++; }
+  tmv.tm_hour = tmv.tm_min = tmv.tm_sec = 0;
+  tmv.tm_isdst = -1;
+  c.fileT = mktime(&tmv);
+}
+
+// primer archivo existente desde fileT; en rollups salta por búsqueda
+// binaria al primer registro que puede solaparse con from
+bool ClogTS::openFileAt(Cursor& c){
+  uint8_t kind = (c.res == RES_RAW) ? 0 : c.res;
+  while ((uint32_t)c.fileT <= c.to) {
+    String path = pathFor(kind, c.fileT, c.ch);
+    if (LittleFS.exists(path)) {
+      c.f = LittleFS.open(path, FILE_READ);
+      if (c.f) break;
+    }
+    advanceFile(c);
+  }
+  if (!c.f) return false;
+
+  if (c.res != RES_RAW) {
+    uint32_t span = SPAN[c.res - 1];
+    uint32_t want = (c.from > span) ? c.from - span : 0;
+    size_t lo = 0, hi = c.f.size() / sizeof(Rollup);
+    while (lo < hi) {
+      size_t mid = (lo + hi) / 2;
+      Rollup ru;
+      c.f.seek(mid * sizeof(Rollup));
+      if (c.f.read((uint8_t*)&ru, sizeof(ru)) != sizeof(ru)) { hi = mid; continue; }
+      if (ru.t < want) lo = mid + 1; else hi = mid;
+    }
+    c.f.seek(lo * sizeof(Rollup));
+  }
+  return true;
+}
+
+bool ClogTS::nextRaw(Cursor& c, Point& p){
+  const float scale = _ch[c.ch].scale;
+  for (;;) {
+    if (c.left) {
+      if (c.left == c.hdr.count) { c.t = c.hdr.t0; c.v = c.hdr.v0; }
+      else {
+        int32_t dt, dv;
+        if (!getVar(c.buf, c.pos, c.hdr.len, dt) || !getVar(c.buf, c.pos, c.hdr.len, dv)) {
+          c.left = 0;            // bloque corrupto: se descarta el resto
+          continue;
+        }
+        c.t += (uint32_t)dt;
+        c.v += dv;
+      }
+      c.left--;
+      if (c.t < c.from) continue;
+      if (c.t > c.to) { c.left = 0; continue; }   // dentro del bloque, t no baja
+      p.t = c.t;
+      p.min = p.max = p.avg = c.v * scale;
+      p.n = 1;
+      return true;
+    }
+
+    // siguiente bloque del canal: archivos, y al final el de RAM
+    if (!c.f && !openFileAt(c)) {
+      if (c.live) return false;
+      c.live = true;
+      const Chan& ch = _ch[c.ch];
+      if (!ch.hdr.count) return false;
+      c.hdr = ch.hdr;
+      c.hdr.t1 = ch.lastT;
+      memcpy(c.buf, ch.buf, ch.hdr.len);
+    } else {
+      if (c.f.read((uint8_t*)&c.hdr, sizeof(c.hdr)) != sizeof(c.hdr) ||
+          c.hdr.magic != BLOCK_MAGIC || c.hdr.len > CLOGTS_BLOCK_BYTES) {
+        advanceFile(c);          // fin (o basura): próximo día
+        continue;
+      }
+      // rango propio del bloque: tras un paso de reloj hacia atrás un
+      // bloque posterior en el archivo puede empezar antes
+      if (c.hdr.ch != _ch[c.ch].tag || !c.hdr.count || c.hdr.t1 < c.from || c.hdr.t0 > c.to) {
+        c.f.seek(c.f.position() + c.hdr.len);
+        continue;
+      }
+      if (c.f.read(c.buf, c.hdr.len) != c.hdr.len) { advanceFile(c); continue; }
+    }
+    if (c.hdr.t1 < c.from || c.hdr.t0 > c.to) continue;
+    c.pos  = 0;
+    c.left = c.hdr.count;
+  }
+}
+
+bool ClogTS::nextRollup(Cursor& c, Point& p){
+  const float    scale = _ch[c.ch].scale;
+  const uint32_t span  = SPAN[c.res - 1];
+  Rollup ru;
+  for (;;) {
+    if (!c.f && !openFileAt(c)) {
+      // al final, el intervalo abierto (parcial)
+      if (c.live) return false;
+      c.live = true;
+      const Acc& a = _ch[c.ch].acc[c.res - 1];
+      if (!a.n || a.t > c.to || a.t + span <= c.from) return false;
+      ru.t = a.t; ru.n = a.n; ru.min = a.min; ru.max = a.max;
+      ru.avg = (int32_t)llround((double)a.sum / a.n);
+    } else {
+      if (c.f.read((uint8_t*)&ru, sizeof(ru)) != sizeof(ru)) { advanceFile(c); continue; }
+      if (ru.ch != _ch[c.ch].tag || ru.res != c.res) continue;
+      if (ru.t + span <= c.from) continue;
+      if (ru.t > c.to) {
+        // el archivo es del canal y va en orden salvo pasos de reloj:
+        // pasado un intervalo, no hay más
+        if (ru.t > c.to + span) { c.fileT = (time_t)c.to + 1; c.f.close(); }
+        continue;
+      }
+    }
+    p.t   = ru.t;
+    p.min = ru.min * scale;
+    p.max = ru.max * scale;
+    p.avg = ru.avg * scale;
+    p.n   = ru.n;
+    return true;
+  }
+}
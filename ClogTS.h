@@ -0,0 +1,155 @@
+// ClogTS.h — series de tiempo compactas al lado de ClogFS.
+// Muestras numéricas por canal en punto fijo (valor / escala → int32),
+// en bloques delta-codificados con varints, en archivos propios por canal
+// que rotan por día. Mantiene rollups automáticos por minuto y por hora (registros
+// de ancho fijo) para leer rangos largos sin decodificar lo crudo.
+#ifndef CLOG_TS_H
+#define CLOG_TS_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <LittleFS.h>
+#include <time.h>
+
+#ifndef CLOGTS_CHANNELS
+#define CLOGTS_CHANNELS    8        // canales registrables
+#endif
+#ifndef CLOGTS_BLOCK_BYTES
+#define CLOGTS_BLOCK_BYTES 256      // bloque crudo en RAM por canal (payload)
+#endif
+#ifndef CLOGTS_FLUSH_MS
+#define CLOGTS_FLUSH_MS    60000    // bloque crudo incompleto → flash cada tanto
+#endif
+
+class ClogTS {
+public:
+  enum Res : uint8_t { RES_RAW = 0, RES_MIN = 1, RES_HOUR = 2 };
+
+  // punto devuelto por las consultas (crudo: min = max = avg, n = 1)
+  struct Point {
+    uint32_t t;
+    float    min, max, avg;
+    uint16_t n;
+  };
+
+  // rollup en flash: 20 bytes, archivos por canal m1-<canal>-YYYYMMDD.bin /
+  // h1-<canal>-YYYYMM.bin; ch es la huella del nombre (no el índice)
+  struct Rollup {
+    uint32_t t;              // inicio del intervalo (epoch)
+    uint8_t  ch, res;
+    uint16_t n;
+    int32_t  min, max, avg;  // en unidades de la escala del canal
+  };
+
+  // cabecera de bloque crudo (raw-<canal>-YYYYMMDD.bin), seguida de len
+  // bytes: por muestra (menos la primera) dt y dv en varint zigzag.
+  // ch es la huella del nombre: el orden de addChannel puede cambiar.
+  // [t0, t1] es el rango del bloque: una consulta salta los que no se
+  // solapan sin decodificarlos (el orden en el archivo no importa)
+  struct BlockHdr {
+    uint16_t magic;
+    uint8_t  ch, flags;
+    uint16_t count, len;
+    uint32_t t0, t1;
+    int32_t  v0;
+  };
+
+  // lectura en streaming (una por conexión web); sin heap
+  struct Cursor {
+    uint8_t  ch, res;
+    bool     done, live;
+    uint32_t from, to;
+    time_t   fileT;          // día/mes del archivo abierto
+    File     f;
+    // bloque crudo en decodificación
+    BlockHdr hdr;
+    uint8_t  buf[CLOGTS_BLOCK_BYTES];
+    uint16_t pos, left;
+    uint32_t t;
+    int32_t  v;
+  };
+
+  ClogTS();
+
+  // config
+  void setTimeProvider(time_t (*nowFn)());
+  void setBasePath(const char* p);                 // default "/ts/"
+  void setRetention(uint16_t rawDays, uint16_t minDays, uint16_t hourMonths);
+  time_t now() const { return _nowFn ? _nowFn() : time(nullptr); }
+  bool begin();
+
+  // canales: escala = resolución (0.01 → centésimas); devuelve id o -1
+  int  addChannel(const char* name, float scale = 0.01f);
+  int  channel(const char* name) const;
+  size_t      channelCount() const { return _nCh; }
+  const char* channelName(size_t i) const { return _ch[i].name; }
+  float       channelScale(size_t i) const { return _ch[i].scale; }
+  uint32_t    channelSamples(size_t i) const { return _ch[i].samples; }
+
+  // muestras (t = hora del time provider; sin hora válida se descarta)
+  bool record(int ch, float value);
+  bool record(int ch, float value, time_t t);
+
+  // bloques crudos pendientes → flash (los rollups abiertos siguen en RAM)
+  void flush();
+  // cierre de minutos/horas vencidos, flush periódico, retención; en loop()
+  void loop();
+
+  // consulta [from, to] a una resolución; los rollups se leen tal cual
+  bool open(Cursor& c, int ch, Res res, time_t from, time_t to);
+  bool next(Cursor& c, Point& p);
+  void close(Cursor& c);
+
+  static const char* resName(Res r);
+  static bool resFromName(const char* s, Res* out);
+
+private:
+  struct Acc {               // rollup abierto
+    uint32_t t;
+    int32_t  min, max;
+    int64_t  sum;
+    uint16_t n;
+  };
+  struct Chan {
+    char     name[16];
+    uint8_t  tag;            // huella del nombre (ch en bloques y rollups)
+    float    scale;
+    uint32_t samples;
+    // bloque crudo en armado
+    BlockHdr hdr;
+    uint8_t  buf[CLOGTS_BLOCK_BYTES];
+    uint32_t lastT;
+    int32_t  lastV;
+    int      day;            // yday del bloque (no cruza archivos)
+    Acc      acc[2];         // RES_MIN, RES_HOUR
+  };
+
+  void   flushBlock(int ch);
+  void   accAdd(int ch, int r, uint32_t t, int32_t v);
+  void   accEmit(int ch, int r);
+  bool   append(const String& path, const void* a, size_t na, const void* b = nullptr, size_t nb = 0);
+  String pathFor(uint8_t kind, time_t t, int ch) const;   // kind: 0 raw, 1 m1, 2 h1
+  void   prune();
+  bool   pruneOldest();
+
+  bool   openFileAt(Cursor& c);
+  bool   nextRaw(Cursor& c, Point& p);
+  bool   nextRollup(Cursor& c, Point& p);
+  void   advanceFile(Cursor& c);
+
+  static uint8_t  nameTag(const char* name);
+  static uint32_t bucketOf(uint32_t t, int r) { return r == 0 ? t - t % 60 : t - t % 3600; }
+  static size_t putVar(uint8_t* p, int32_t v);
+  static bool   getVar(const uint8_t* p, uint16_t& pos, uint16_t end, int32_t& v);
+
+  time_t (*_nowFn)();
+  String   _basePath;
+  uint16_t _keepRaw, _keepMin, _keepHour;
+  bool     _ready;
+  Chan     _ch[CLOGTS_CHANNELS];
+  uint8_t  _nCh;
+  uint32_t _flushT0;
+  int      _pruneDay;
+};
+
+#endif // CLOG_TS_H
@@ -1,5 +1,10 @@
 #include "LogWeb.h"
-#include <vector>
+#include "ClogJson.h"
+#include <cstdarg>
+#if defined(ARDUINO_ARCH_ESP32)
+  #include <lwip/sockets.h>
+  #include <errno.h>
+#endif
 
 // ─────────────────────────────────────────────────────────────────────────────
 // ctor
@@ -8,7 +13,11 @@ LogWeb::LogWeb(uint16_t port, const char* basePath)
 : port_(port ? port : 80),
   basePath_(basePath ? basePath : "/"),
   server_(port_),
-  webMode_(false)
+  conns_(),
+  webMode_(false),
+  started_(false),
+  log_(nullptr),
+  ts_(nullptr)
 {
   if (!basePath_.startsWith("/")) basePath_ = "/" + basePath_;
   if (!basePath_.endsWith("/"))   basePath_ += "/";
@@ -18,14 +27,18 @@ LogWeb::LogWeb(uint16_t port, const char* basePath)
 // público
 // ─────────────────────────────────────────────────────────────────────────────
 void LogWeb::begin() {
-  setupEndpoints();
   server_.begin();
+  server_.setNoDelay(true);
+  started_ = true;
 }
 
+// una vuelta: aceptar + un tramo por conexión (ninguna monopoliza)
+// /fs/recent, /fs/channels y /ts se atienden siempre; el resto sólo en modo CFG
 void LogWeb::loop() {
-  if (webMode_) {
-    server_.handleClient();
-    delay(1);
+  if (!started_) return;
+  accept();
+  for (auto& c : conns_) {
+    if (c.st != C_FREE) service(c);
   }
 }
 
@@ -44,21 +57,329 @@ void LogWeb::setBasePath(const String& base) {
   if (!basePath_.endsWith("/"))   basePath_ += "/";
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+// conexiones
+// ─────────────────────────────────────────────────────────────────────────────
+void LogWeb::accept() {
+  WiFiClient nc = server_.available();
+  if (!nc) return;
+
+  for (auto& c : conns_) {
+    if (c.st != C_FREE) continue;
+    c.client   = nc;
+    c.client.setNoDelay(true);
+    c.st       = C_READ;
+    c.kind     = B_NONE;
+    c.tLast    = millis();
+    c.ioLen    = c.ioSent = 0;
+    c.outLen   = c.outSent = 0;
+    return;
+  }
+  // sin lugar
+  static const char busy[] = "HTTP/1.1 503 Service Unavailable\r\n"
+                             "Retry-After: 1\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+  nc.write((const uint8_t*)busy, sizeof(busy) - 1);
+  nc.stop();
+}
+
+void LogWeb::closeConn(Conn& c) {
+  if (c.file) c.file.close();
+  if (c.dirEnt) c.dirEnt.close();
+  if (c.kind == B_TS && ts_) ts_->close(c.tsCur);
+  c.client.stop();
+  c.mem = String();
+  std::vector<String>().swap(c.arcNames);
+  c.st   = C_FREE;
+  c.kind = B_NONE;
+}
+
+void LogWeb::service(Conn& c) {
+  if (!c.client.connected() && !(c.st == C_READ && c.client.available())) {
+    closeConn(c);
+    return;
+  }
+  if (millis() - c.tLast > LOGWEB_IDLE_MS) { closeConn(c); return; }
+
+  if (c.st == C_READ) {
+    int avail = c.client.available();
+    if (avail <= 0) return;
+    size_t room = sizeof(c.io) - 1 - c.ioLen;
+    if (room == 0) {
+      c.ioLen = 0;
+      sendText(c, 431, "text/plain", "request too large");
+      return;
+    }
+    int n = c.client.read((uint8_t*)c.io + c.ioLen, (size_t)avail < room ? (size_t)avail : room);
+    if (n <= 0) return;
+    c.ioLen += n;
+    c.io[c.ioLen] = 0;
+    c.tLast = millis();
+
+    if (!strstr(c.io, "\r\n\r\n")) return;   // headers incompletos
+    Req r;
+    if (!parseRequest(c.io, c.ioLen, r)) { sendText(c, 400, "text/plain", "bad request"); return; }
+    if (!r.get)                          { sendText(c, 405, "text/plain", "GET only");    return; }
+    handle(c, r);
+    return;
+  }
+
+  // C_SEND: primero la cabecera, después un tramo del cuerpo. Lo que el
+  // socket no aceptó queda en out y sale en la vuelta siguiente, antes
+  // de pedirle más al productor
+  if (c.ioSent < c.ioLen) {
+    int w = sendSome(c, (const uint8_t*)c.io + c.ioSent, c.ioLen - c.ioSent);
+    if (w < 0) { closeConn(c); return; }
+    if (w > 0) { c.ioSent += w; c.tLast = millis(); }
+    return;
+  }
+  if (c.outSent == c.outLen) {
+    c.outLen  = produce(c, c.out, sizeof(c.out));
+    c.outSent = 0;
+    if (c.outLen == 0) { closeConn(c); return; }
+  }
+  int w = sendSome(c, c.out + c.outSent, c.outLen - c.outSent);
+  if (w < 0) { closeConn(c); return; }
+  if (w > 0) { c.outSent += w; c.tLast = millis(); }
+}
+
+// lo que el socket acepte ahora, sin esperar: 0 = ventana llena, -1 = caída.
+// En ESP32 WiFiClient::write() reintenta con select() y frena loop(); se
+// manda directo al socket con MSG_DONTWAIT
+int LogWeb::sendSome(Conn& c, const uint8_t* p, size_t n) {
+#if defined(ARDUINO_ARCH_ESP32)
+  int fd = c.client.fd();
+  if (fd < 0) return -1;
+  int w = lwip_send(fd, p, n, MSG_DONTWAIT);
+  if (w < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+  return w;
+#else
+  size_t w = c.client.write(p, n);
+  return w ? (int)w : -1;
+#endif
+}
+
+size_t LogWeb::produce(Conn& c, uint8_t* buf, size_t max) {
+  switch (c.kind) {
+    case B_MEM: {
+      size_t n = c.mem.length() - c.memSent;
+      if (n > max) n = max;
+      memcpy(buf, c.mem.c_str() + c.memSent, n);
+      c.memSent += n;
+      return n;
+    }
+    case B_FILE: {
+      if (!c.fileLeft || !c.file) return 0;
+      int n = c.file.read(buf, c.fileLeft < max ? c.fileLeft : max);
+      if (n <= 0) return 0;
+      c.fileLeft -= n;
+      return (size_t)n;
+    }
+    case B_ARCHIVE:
+      return produceArchive(c, buf, max);
+    case B_TS:
+      return produceTs(c, buf, max);
+    case B_FRAMED:
+      return produceFramed(c, buf, max);
+    case B_RECENT:
+      return produceRecent(c, buf, max);
+    case B_CHANNELS:
+      return produceChannels(c, buf, max);
+    case B_DIR:
+      return produceDir(c, buf, max);
+    default:
+      return 0;
+  }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// request / respuesta (sin heap)
+// ─────────────────────────────────────────────────────────────────────────────
+
+// "GET /fs/view?path=x HTTP/1.1\r\nHeader: v\r\n...\r\n\r\n"
+bool LogWeb::parseRequest(char* io, size_t len, Req& r) {
+  memset(&r, 0, sizeof(r));
+  char* end = io + len;
+  char* eol = strstr(io, "\r\n");
+  if (!eol) return false;
+
+  char* sp1 = (char*)memchr(io, ' ', eol - io);
+  if (!sp1) return false;
+  r.get = (sp1 - io == 3 && memcmp(io, "GET", 3) == 0);
+  char* uri = sp1 + 1;
+  char* sp2 = (char*)memchr(uri, ' ', eol - uri);
+  if (!sp2) sp2 = eol;
+  char* q = (char*)memchr(uri, '?', sp2 - uri);
+  r.path    = uri;
+  r.pathLen = (q ? q : sp2) - uri;
+  if (q) { r.query = q + 1; r.queryLen = sp2 - (q + 1); }
+
+  // headers que interesan (validadores)
+  for (char* h = eol + 2; h < end; ) {
+    char* e = strstr(h, "\r\n");
+    if (!e || e == h) break;
+    char* colon = (char*)memchr(h, ':', e - h);
+    if (colon) {
+      char* v = colon + 1;
+      while (v < e && *v == ' ') ++v;
+      size_t kl = colon - h;
+      if (kl == 13 && strncasecmp(h, "If-None-Match", 13) == 0)     { r.inm = v; r.inmLen = e - v; }
+      if (kl == 17 && strncasecmp(h, "If-Modified-Since", 17) == 0) { r.ims = v; r.imsLen = e - v; }
+    }
+    h = e + 2;
+  }
+  return true;
+}
+
+bool LogWeb::pathIs(const Req& r, const char* p) {
+  size_t n = strlen(p);
+  return r.pathLen == n && memcmp(r.path, p, n) == 0;
+}
+
+// valor decodificado de ?key=... en out (truncado a outLen-1)
+bool LogWeb::queryArg(const Req& r, const char* key, char* out, size_t outLen) {
+  size_t kl = strlen(key);
+  const char* p   = r.query;
+  const char* end = r.query + r.queryLen;
+  while (p && p < end) {
+    const char* amp = (const char*)memchr(p, '&', end - p);
+    if (!amp) amp = end;
+    if ((size_t)(amp - p) > kl && memcmp(p, key, kl) == 0 && p[kl] == '=') {
+      urlDecode(p + kl + 1, amp - (p + kl + 1), out, outLen);
+      return true;
+    }
+    if ((size_t)(amp - p) == kl && memcmp(p, key, kl) == 0) { out[0] = 0; return true; }
+    p = amp + 1;
+  }
+  if (outLen) out[0] = 0;
+  return false;
+}
+
+size_t LogWeb::urlDecode(const char* src, size_t n, char* dst, size_t dstLen) {
+  auto hex = [](char h)->int{
+    if(h>='0'&&h<='9') return h-'0';
+    if(h>='A'&&h<='F') return 10+(h-'A');
+    if(h>='a'&&h<='f') return 10+(h-'a');
+    return -1;
+  };
+  size_t o = 0;
+  for (size_t i = 0; i < n && o + 1 < dstLen; ++i) {
+    char c = src[i];
+    if (c == '%' && i + 2 < n) {
+      int v1 = hex(src[i+1]), v2 = hex(src[i+2]);
+      if (v1 >= 0 && v2 >= 0) { dst[o++] = char(v1*16 + v2); i += 2; continue; }
+    }
+    dst[o++] = (c == '+') ? ' ' : c;
+  }
+  dst[o] = 0;
+  return o;
+}
+
+// ruta absoluta bajo basePath_, sin ".."
+void LogWeb::sanitizePath(const char* raw, char* out, size_t outLen) const {
+  const char* b = basePath_.c_str();
+  size_t bl = basePath_.length();
+  const char* p = raw;
+  while (*p == '/') ++p;
+  if (strncmp(p, b + 1, bl - 1) == 0) p += bl - 1;   // ya venía con la base
+
+  size_t o = 0;
+  for (size_t i = 0; i < bl && o + 1 < outLen; ++i) out[o++] = b[i];
+  for (; *p && o + 1 < outLen; ++p) {
+    if (p[0] == '.' && p[1] == '.') { ++p; continue; }
+    out[o++] = *p;
+  }
+  out[o] = 0;
+}
+
+static const char* statusText(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 409: return "Conflict";
+    case 431: return "Request Header Fields Too Large";
+    case 503: return "Service Unavailable";
+    default:  return "Internal Server Error";
+  }
+}
+
+// cabecera en c.io (el request ya no se necesita); len = SIZE_MAX → sin Content-Length
+void LogWeb::beginResponse(Conn& c, int code, const char* type, size_t len, const char* extra) {
+  int n = snprintf(c.io, sizeof(c.io), "HTTP/1.1 %d %s\r\nConnection: close\r\n",
+                   code, statusText(code));
+  if (type && n < (int)sizeof(c.io))
+    n += snprintf(c.io + n, sizeof(c.io) - n, "Content-Type: %s\r\n", type);
+  if (len != (size_t)-1 && n < (int)sizeof(c.io))
+    n += snprintf(c.io + n, sizeof(c.io) - n, "Content-Length: %u\r\n", (unsigned)len);
+  if (extra && n < (int)sizeof(c.io))
+    n += snprintf(c.io + n, sizeof(c.io) - n, "%s", extra);
+  if (n < (int)sizeof(c.io))
+    n += snprintf(c.io + n, sizeof(c.io) - n, "\r\n");
+  c.ioLen  = (n < (int)sizeof(c.io)) ? n : sizeof(c.io) - 1;
+  c.ioSent = 0;
+  c.outLen = c.outSent = 0;
+  c.st     = C_SEND;
+  c.kind   = B_NONE;
+}
+
+void LogWeb::sendText(Conn& c, int code, const char* type, const String& body, const char* extra) {
+  beginResponse(c, code, type, body.length(), extra);
+  c.mem     = body;
+  c.memSent = 0;
+  c.kind    = B_MEM;
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 // endpoints
 // ─────────────────────────────────────────────────────────────────────────────
-void LogWeb::setupEndpoints() {
+void LogWeb::handle(Conn& c, const Req& r) {
   // raíz → /fs
-  server_.on("/", HTTP_GET, [this](){
-    server_.sendHeader("Location", "/fs");
-    server_.send(302);
-  });
+  if (pathIs(r, "/")) {
+    beginResponse(c, 302, nullptr, 0, "Location: /fs\r\n");
+    return;
+  }
+  if (pathIs(r, "/fs/recent"))   { handleRecent(c, r); return; }
+  if (pathIs(r, "/fs/channels")) { handleChannels(c);  return; }
+  if (pathIs(r, "/ts"))          { handleTs(c, r);     return; }
+
+  bool fsPath = pathIs(r, "/fs") || pathIs(r, "/fs/erase") || pathIs(r, "/fs/view") ||
+                pathIs(r, "/fs/download") || pathIs(r, "/fs/archive");
+  if (!fsPath) { sendText(c, 404, "text/plain", "not found"); return; }
+
+  // endpoints de archivos: sólo en modo CFG (archivo de log cerrado)
+  if (!webMode_) { sendText(c, 409, "text/plain", "cfg mode required (cfg on)"); return; }
 
-    // borrar todos los archivos
-  server_.on("/fs/erase", HTTP_GET, [this](){
+  if (pathIs(r, "/fs/erase"))    { handleErase(c);              return; }
+  if (pathIs(r, "/fs/view"))     { handleFile(c, r, false);     return; }
+  if (pathIs(r, "/fs/download")) { handleFile(c, r, true);      return; }
+  if (pathIs(r, "/fs/archive"))  { handleArchive(c, r);         return; }
+
+  // listar (?ch= filtra por canal)
+  char raw[64], path[96];
+  int ch;
+  if (!queryChannel(c, r, ch)) return;
+  if (queryArg(r, "path", raw, sizeof(raw))) sanitizePath(raw, path, sizeof(path));
+  else strncpy(path, basePath_.c_str(), sizeof(path) - 1), path[sizeof(path) - 1] = 0;
+  handleDir(c, path, ch);
+}
+
+// borrar todos los archivos
+void LogWeb::handleErase(Conn& c) {
+  size_t ok = 0, fail = 0;
+  if (useManifest(basePath_)) {
+    std::vector<String> segs;
+    for (size_t i = 0; i < log_->segmentCount(); ++i) segs.push_back(log_->segment(i).name);
+    for (const auto& n : segs) {
+      log_->removeSegment(n.c_str()) ? ok++ : fail++;
+      delay(1);
+    }
+  } else {
     File root = LittleFS.open(basePath_, FILE_READ);
     if (!root || !root.isDirectory()) {
-      server_.send(500, "text/plain", "directorio inválido");
+      sendText(c, 500, "text/plain", "directorio inválido");
       return;
     }
 
@@ -68,14 +389,10 @@ void LogWeb::setupEndpoints() {
     }
     root.close();
 
-    size_t ok = 0, fail = 0;
     for (const auto& n : names) {
       // Normalizar a ruta absoluta bajo basePath_
       String full = n;
-      if (!full.startsWith("/")) {
-        if (basePath_.endsWith("/")) full = basePath_ + full;
-        else                         full = basePath_ + "/" + full;
-      }
+      if (!full.startsWith("/")) full = basePath_ + full;
 
       // Intento principal
       bool removed = LittleFS.remove(full);
@@ -91,127 +408,771 @@ void LogWeb::setupEndpoints() {
       removed ? ok++ : fail++;
       delay(1); // cooperar con WDT si hay muchos archivos
     }
+  }
+
+  sendText(c, 302, "text/plain", String("logs borrados ok=") + ok + " fail=" + fail,
+           "Location: /fs\r\n");
+}
+
+// ver / descargar archivo. Los rotados no cambian más: ETag + Last-Modified
+// y 304 si el cliente ya tiene esa versión.
+void LogWeb::handleFile(Conn& c, const Req& r, bool download) {
+  char raw[64], path[96];
+  if (!queryArg(r, "path", raw, sizeof(raw))) { sendText(c, 400, "text/plain", "missing path"); return; }
+  sanitizePath(raw, path, sizeof(path));
+  if (!LittleFS.exists(path)) { sendText(c, 404, "text/plain", "not found"); return; }
+  File f = LittleFS.open(path, FILE_READ);
+  if (!f) { sendText(c, 500, "text/plain", "open fail"); return; }
+
+  const char* name = strrchr(path, '/') + 1;
+  size_t sz = f.size();
+  char extra[256];
+  int n = 0;
+
+  if (isImmutable(name)) {
+    time_t mt = f.getLastWrite();
+    char etag[32];
+    snprintf(etag, sizeof(etag), "\"%lx-%lx\"", (unsigned long)sz, (unsigned long)mt);
+    n += snprintf(extra + n, sizeof(extra) - n, "ETag: %s\r\nCache-Control: no-cache\r\n", etag);
+    bool validTime = mt > 1577836800;          // 2020-01-01: hora real (NTP)
+    if (validTime) {
+      char d[40];
+      httpDate(mt, d, sizeof(d));
+      n += snprintf(extra + n, sizeof(extra) - n, "Last-Modified: %s\r\n", d);
+    }
 
-    server_.sendHeader("Location", "/fs");
-    server_.send(302, "text/plain",
-                 String("logs borrados ok=") + ok + " fail=" + fail);
-  });
+    bool notModified = false;
+    if (r.inm) {
+      notModified = etagMatch(r.inm, r.inmLen, etag);
+    } else if (r.ims && validTime) {
+      time_t since = parseHttpDate(r.ims, r.imsLen);
+      notModified = since > 0 && mt <= since;
+    }
+    if (notModified) {
+      f.close();
+      beginResponse(c, 304, nullptr, (size_t)-1, extra);
+      return;
+    }
+  } else {
+    n += snprintf(extra + n, sizeof(extra) - n, "Cache-Control: no-store\r\n");
+  }
+
+  if (download) {
+    snprintf(extra + n, sizeof(extra) - n, "Content-Disposition: attachment; filename=%s\r\n", name);
+    beginResponse(c, 200, "application/octet-stream", sz, extra);
+    c.file     = f;
+    c.fileLeft = sz;
+    c.kind     = B_FILE;
+    return;
+  }
 
- 
+  // ver: bloque por bloque, sin trailers; el largo final no se conoce
+  beginResponse(c, 200, "text/plain; charset=utf-8", (size_t)-1, extra);
+  c.file      = f;
+  c.kind      = B_FRAMED;
+  c.frPhase   = F_SCAN;
+  c.frMid     = false;
+  c.frJson    = strstr(name, ".jsonl") != nullptr;
+  c.frSize    = (uint32_t)sz;
+  c.frPos     = c.frRegion = 0;
+  c.frCrc     = 0;
+}
+
+// /fs/view de a bloques: SCAN busca el próximo trailer acumulando el CRC
+// de la región; si cuadra se emite (F_EMIT, releyendo del archivo), si no
+// se reemplaza por una línea "#X corrupt ..." (F_MARK). Sin trailers
+// (archivo viejo, cola abierta) el texto sale tal cual cada
+// CLOGFS_FRAME_MAX bytes. Devolver 0 cierra la conexión: se sigue hasta
+// tener algo que enviar.
+size_t LogWeb::produceFramed(Conn& c, uint8_t* buf, size_t max) {
+  for (;;) {
+    switch (c.frPhase) {
+      case F_SCAN: {
+        if (c.frPos >= c.frSize) {                     // fin: cola sin trailer
+          c.frEmit = c.frRegion; c.frEmitEnd = c.frNext = c.frSize;
+          c.frOk = true; c.frPhase = F_EMIT;
+          continue;
+        }
+        if (c.frPos - c.frRegion > CLOGFS_FRAME_MAX) { // sin marcos
+          c.frEmit = c.frRegion; c.frEmitEnd = c.frNext = c.frPos;
+          c.frOk = true; c.frPhase = F_EMIT;
+          continue;
+        }
+        size_t want = c.frSize - c.frPos < max ? c.frSize - c.frPos : max;
+        c.file.seek(c.frPos);
+        int n = c.file.read(buf, want);
+        if (n <= 0) { c.frSize = c.frPos; continue; }
 
+        size_t i = 0;
+        bool trailer = false;
+        uint32_t seq, len, crc;
+        while (i < (size_t)n) {
+          const uint8_t* nl = (const uint8_t*)memchr(buf + i, '\n', n - i);
+          if (!nl) {
+            // línea cortada por el tramo: si puede ser un trailer se relee entera
+            if (!c.frMid && i > 0 && n - i <= 32) break;
+            c.frCrc = ClogFS::crc32(c.frCrc, buf + i, n - i);
+            c.frMid = true;
+            i = n;
+            break;
+          }
+          size_t e = (nl - buf) + 1;
+          if (!c.frMid && ClogFS::parseFrameTrailer((const char*)buf + i, e - i - 1, &seq, &len, &crc)) {
+            trailer = true;
+            break;
+          }
+          c.frCrc = ClogFS::crc32(c.frCrc, buf + i, e - i);
+          c.frMid = false;
+          i = e;
+        }
+        if (!trailer) { c.frPos += i; continue; }
 
-  // listar
-  server_.on("/fs", HTTP_GET, [this](){
-    String path = basePath_;
-    if (server_.hasArg("path")) {
-      path = sanitizePath(server_.arg("path"), basePath_);
+        uint32_t at = c.frPos + i;
+        c.frEmit    = c.frRegion;
+        c.frEmitEnd = at;
+        c.frNext    = at + (uint32_t)((const uint8_t*)memchr(buf + i, '\n', n - i) - (buf + i)) + 1;
+        if (len == at - c.frRegion) {
+          c.frOk = (c.frCrc == crc);
+          c.frPhase = c.frOk ? F_EMIT : F_MARK;
+        } else if (len <= at && len <= CLOGFS_FRAME_MAX) {
+          // el bloque no empieza en la región (marcos activados a mitad de
+          // archivo, cola recuperada): se verifica releyendo sus len bytes
+          c.frPos  = at - len;
+          c.frCrc  = 0;
+          c.frWant = crc;
+          c.frPhase = F_VERIFY;
+        } else {
+          c.frOk = false;
+          c.frPhase = F_MARK;
+        }
+        continue;
+      }
+      case F_VERIFY: {
+        if (c.frPos >= c.frEmitEnd) {
+          c.frOk = (c.frCrc == c.frWant);
+          c.frPhase = c.frOk ? F_EMIT : F_MARK;
+          continue;
+        }
+        size_t want = c.frEmitEnd - c.frPos < max ? c.frEmitEnd - c.frPos : max;
+        c.file.seek(c.frPos);
+        int n = c.file.read(buf, want);
+        if (n <= 0) { c.frCrc = ~c.frWant; c.frPos = c.frEmitEnd; continue; }
+        c.frCrc = ClogFS::crc32(c.frCrc, buf, n);
+        c.frPos += n;
+        continue;
+      }
+      case F_EMIT: {
+        if (c.frEmit < c.frEmitEnd) {
+          size_t want = c.frEmitEnd - c.frEmit < max ? c.frEmitEnd - c.frEmit : max;
+          c.file.seek(c.frEmit);
+          int n = c.file.read(buf, want);
+          if (n > 0) { c.frEmit += n; return (size_t)n; }
+        }
+        c.frPhase = (c.frNext >= c.frSize) ? F_DONE : F_SCAN;
+        c.frPos = c.frRegion = c.frNext;
+        c.frCrc = 0;
+        c.frMid = c.frMid && c.frNext == c.frEmitEnd;   // corte sin marcos: puede caer en mitad de línea
+        continue;
+      }
+      case F_MARK: {
+        int n = c.frJson
+              ? snprintf((char*)buf, max, "{\"#X\":\"corrupt block @%lu (%lu bytes)\"}\r\n",
+                         (unsigned long)c.frEmit, (unsigned long)(c.frEmitEnd - c.frEmit))
+              : snprintf((char*)buf, max, "#X corrupt block @%lu (%lu bytes)\r\n",
+                         (unsigned long)c.frEmit, (unsigned long)(c.frEmitEnd - c.frEmit));
+        c.frEmit = c.frEmitEnd;
+        c.frPhase = F_EMIT;                            // sólo avanza
+        return (size_t)n;
+      }
+      default:
+        return 0;
     }
-    server_.send(200, "text/html; charset=utf-8", renderDirHTML(path));
-  });
+  }
+}
+
+// fila entera o nada en lo que queda del tramo: n avanza sólo si entra
+static bool putRow(char* out, size_t& n, size_t max, const char* fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  int k = vsnprintf(out + n, max - n, fmt, ap);
+  va_end(ap);
+  if (k < 0 || (size_t)k >= max - n) return false;
+  n += (size_t)k;
+  return true;
+}
 
-  // ver archivo
-  server_.on("/fs/view", HTTP_GET, [this](){
-    if (!server_.hasArg("path")) { server_.send(400, "text/plain", "missing path"); return; }
-    String path = sanitizePath(server_.arg("path"), basePath_);
-    if (!LittleFS.exists(path))  { server_.send(404, "text/plain", "not found");   return; }
-    File f = LittleFS.open(path, FILE_READ);
-    if (!f) { server_.send(500, "text/plain", "open fail"); return; }
-    server_.streamFile(f, "text/plain; charset=utf-8");
-    f.close();
-  });
+// últimas líneas desde la caché en RAM (sin LittleFS, sin pausar el log)
+//   /fs/recent?sev=WARN&n=50[&ch=sensors][&fmt=json]
+// Se entregan en tramos: lo que se loguee mientras tanto no entra en la
+// respuesta y lo que la caché descarte antes de salir se saltea.
+void LogWeb::handleRecent(Conn& c, const Req& r) {
+  if (!log_ || !log_->recentCacheBytes()) {
+    sendText(c, 503, "text/plain", "recent cache off");
+    return;
+  }
+  int ch;
+  if (!queryChannel(c, r, ch)) return;
+  char arg[16];
+  ClogFS::Severity sev = ClogFS::TRACE;
+  if (queryArg(r, "sev", arg, sizeof(arg)) && !ClogFS::sevFromName(arg, &sev)) {
+    sendText(c, 400, "text/plain", "sev: TRACE|DEBUG|INFO|WARN|ERROR|CRIT");
+    return;
+  }
+  size_t n = queryArg(r, "n", arg, sizeof(arg)) ? (size_t)atoi(arg) : 0;
+  bool json = queryArg(r, "fmt", arg, sizeof(arg)) && strcmp(arg, "json") == 0;
 
-  // descargar archivo
-  server_.on("/fs/download", HTTP_GET, [this](){
-    if (!server_.hasArg("path")) { server_.send(400, "text/plain", "missing path"); return; }
-    String path = sanitizePath(server_.arg("path"), basePath_);
-    if (!LittleFS.exists(path))  { server_.send(404, "text/plain", "not found");   return; }
-    File f = LittleFS.open(path, FILE_READ);
-    if (!f) { server_.send(500, "text/plain", "open fail"); return; }
+  beginResponse(c, 200, json ? "application/json" : "text/plain; charset=utf-8", (size_t)-1,
+                "Cache-Control: no-store\r\n");
+  log_->recentOpen(c.rcCur, sev, n, ch);
+  c.kind     = B_RECENT;
+  c.rowPhase = R_HEAD;
+  c.rowJson  = json;
+  c.rowFirst = true;
+}
 
-    String name = path.substring(path.lastIndexOf('/') + 1);
-    server_.setContentLength(f.size());
-    server_.sendHeader("Content-Disposition", "attachment; filename=" + name);
-    server_.send(200, "application/octet-stream", "");
-    uint8_t buf[1024];
-    while (int n = f.read(buf, sizeof(buf))) {
-      server_.client().write(buf, n);
-      delay(0);
+size_t LogWeb::produceRecent(Conn& c, uint8_t* buf, size_t max) {
+  char* out = (char*)buf;
+  size_t n = 0;
+  if (c.rowPhase == R_HEAD) {
+    if (c.rowJson && !putRow(out, n, max, "{\"lines\":[")) return 0;
+    c.rowPhase = R_ROWS;
+  }
+  while (c.rowPhase == R_ROWS) {
+    uint32_t at = c.rcCur.pos;
+    char line[256];
+    size_t len;
+    ClogFS::Severity s;
+    bool trunc;
+    if (!log_->recentNext(c.rcCur, line, sizeof(line), &len, &s, &trunc)) { c.rowPhase = R_TAIL; break; }
+    bool fits;
+    if (c.rowJson) {
+      JsonWriter w(out + n, max - n);
+      if (!c.rowFirst) w.ch(',');
+      w.raw("{").key("sev").str(ClogFS::sevName(s)).key("line").str(line, len);
+      if (trunc) w.key("trunc").boolean(true);
+      w.ch('}');
+      fits = !w.overflow();
+      if (fits) n += w.length();
+    } else {
+      fits = putRow(out, n, max, "%.*s%s\n", (int)len, line, trunc ? " [...]" : "");
     }
-    f.close();
-  });
+    if (fits) { c.rowFirst = false; continue; }
+    if (n) { c.rcCur.pos = at; break; }        // al próximo tramo
+    // no entra ni en un tramo vacío: se omite
+  }
+  if (c.rowPhase == R_TAIL && (!c.rowJson || putRow(out, n, max, "]}"))) c.rowPhase = R_DONE;
+  return n;
+}
+
+// canales del logger: umbral, cuota y lo que ocupan en flash
+//   /fs/channels → {"budget":..,"channels":[{"name":..,"sev":..,"quota":..,"maxFile":..,"bytes":..,"files":..}]}
+void LogWeb::handleChannels(Conn& c) {
+  if (!log_) { sendText(c, 503, "text/plain", "no logger"); return; }
+  beginResponse(c, 200, "application/json", (size_t)-1, "Cache-Control: no-store\r\n");
+  c.kind     = B_CHANNELS;
+  c.rowPhase = R_HEAD;
+  c.rowIdx   = 0;
+}
+
+size_t LogWeb::produceChannels(Conn& c, uint8_t* buf, size_t max) {
+  char* out = (char*)buf;
+  size_t n = 0;
+  if (c.rowPhase == R_HEAD) {
+    if (!putRow(out, n, max, "{\"budget\":%lu,\"channels\":[", (unsigned long)log_->flashBudget())) return 0;
+    c.rowPhase = R_ROWS;
+  }
+  for (; c.rowPhase == R_ROWS; c.rowIdx++) {
+    size_t i = c.rowIdx;
+    if (i >= log_->channelCount()) { c.rowPhase = R_TAIL; break; }
+    unsigned files = 0;
+    for (size_t k = 0; k < log_->segmentCount(); ++k) {
+      if (log_->channelOfFile(log_->segment(k).name) == (int)i) files++;
+    }
+    if (!putRow(out, n, max,
+                "%s{\"name\":\"%s\",\"sev\":\"%s\",\"quota\":%lu,\"maxFile\":%lu,\"bytes\":%lu,\"files\":%u}",
+                i ? "," : "", log_->channelName(i), ClogFS::sevName(log_->channelMinSeverity(i)),
+                (unsigned long)log_->channelQuota(i), (unsigned long)log_->channelMaxFile(i),
+                (unsigned long)log_->channelBytes(i), files)) {
+      if (n) return n;                          // al próximo tramo
+    }
+  }
+  if (c.rowPhase == R_TAIL && putRow(out, n, max, "]}")) c.rowPhase = R_DONE;
+  return n;
+}
+
+// descargar varios archivos en un solo .tar (ustar), en streaming
+//   /fs/archive?from=YYYYMMDD[-HHMMSS]&to=YYYYMMDD[-HHMMSS]&glob=log-2025*.txt[&ch=audit]
+// Sin archivo temporal: cabecera + contenido de cada archivo directo al socket.
+// Los archivos se copian byte a byte (los ya comprimidos pasan tal cual).
+void LogWeb::handleArchive(Conn& c, const Req& r) {
+  char from[24], to[24], glob[48];
+  queryArg(r, "from", from, sizeof(from));
+  queryArg(r, "to",   to,   sizeof(to));
+  queryArg(r, "glob", glob, sizeof(glob));
+  int ch;
+  if (!queryChannel(c, r, ch)) return;
+
+  // selección + tamaño total (para Content-Length)
+  std::vector<String> names;
+  size_t total = 1024;                        // 2 bloques cero de cierre
+  if (useManifest(basePath_)) {
+    for (size_t i = 0; i < log_->segmentCount(); ++i) {
+      const ClogFS::Segment& sg = log_->segment(i);
+      if (!archiveSelect(sg.name, from, to, glob)) continue;
+      if (ch >= 0 && log_->channelOfFile(sg.name) != ch) continue;
+      total += 512 + ((sg.size + 511) & ~(size_t)511);
+      names.push_back(sg.name);
+    }
+  } else {
+    File root = LittleFS.open(basePath_, FILE_READ);
+    if (!root || !root.isDirectory()) {
+      sendText(c, 500, "text/plain", "directorio inválido");
+      return;
+    }
+    for (File f = root.openNextFile(); f; f = root.openNextFile()) {
+      if (f.isDirectory()) continue;
+      String name = f.name();
+      if (name == ClogFS::manifestName()) continue;
+      if (!archiveSelect(name.c_str(), from, to, glob)) continue;
+      if (ch >= 0 && log_->channelOfFile(name.c_str()) != ch) continue;
+      size_t sz = f.size();
+      total += 512 + ((sz + 511) & ~(size_t)511);
+      names.push_back(name);
+    }
+    root.close();
+  }
+
+  if (names.empty()) { sendText(c, 404, "text/plain", "no files"); return; }
+
+  beginResponse(c, 200, "application/x-tar", total,
+                "Content-Disposition: attachment; filename=logs.tar\r\n");
+  c.arcNames.swap(names);
+  c.arcIdx   = 0;
+  c.arcLeft  = c.arcPad = 0;
+  c.arcPhase = A_HEADER;
+  c.kind     = B_ARCHIVE;
+}
+
+// siguiente tramo del tar; el largo ya anunciado manda: si un archivo
+// cambió se trunca o se rellena con ceros
+size_t LogWeb::produceArchive(Conn& c, uint8_t* buf, size_t max) {
+  for (;;) {
+    switch (c.arcPhase) {
+      case A_HEADER: {
+        if (c.arcIdx >= c.arcNames.size()) { c.arcPhase = A_TRAILER; continue; }
+        const String& n = c.arcNames[c.arcIdx];
+        c.file = LittleFS.open(basePath_ + n, FILE_READ);
+        size_t sz = 0;
+        if (useManifest(basePath_)) {
+          const ClogFS::Segment* sg = log_->findSegment(n.c_str());
+          sz = sg ? sg->size : 0;
+        } else if (c.file) {
+          sz = c.file.size();
+        }
+        tarHeader(buf, n.c_str(), sz, c.file ? c.file.getLastWrite() : 0);
+        c.arcLeft  = sz;
+        c.arcPad   = ((sz + 511) & ~(size_t)511) - sz;
+        c.arcPhase = A_BODY;
+        return 512;
+      }
+      case A_BODY: {
+        int n = (c.arcLeft && c.file) ? c.file.read(buf, c.arcLeft < max ? c.arcLeft : max) : 0;
+        if (n <= 0) {                          // terminó (o se achicó)
+          c.arcPad  += c.arcLeft;
+          c.arcLeft  = 0;
+          if (c.file) c.file.close();
+          c.arcPhase = A_PAD;
+          continue;
+        }
+        c.arcLeft -= n;
+        return (size_t)n;
+      }
+      case A_PAD: {
+        if (!c.arcPad) { c.arcIdx++; c.arcPhase = A_HEADER; continue; }
+        size_t k = c.arcPad < max ? c.arcPad : max;
+        memset(buf, 0, k);
+        c.arcPad -= k;
+        return k;
+      }
+      case A_TRAILER:
+        memset(buf, 0, 1024);
+        c.arcPhase = A_DONE;
+        return 1024;
+      default:
+        return 0;
+    }
+  }
+}
+
+// listado HTML de un directorio (o del manifest), por filas
+void LogWeb::handleDir(Conn& c, const char* path, int ch) {
+  beginResponse(c, 200, "text/html; charset=utf-8", (size_t)-1);
+  strncpy(c.dirPath, path, sizeof(c.dirPath) - 1);
+  c.dirPath[sizeof(c.dirPath) - 1] = 0;
+  c.rowMan = useManifest(String(c.dirPath));
+  if (!c.rowMan) c.file = LittleFS.open(c.dirPath, FILE_READ);
+  c.kind     = B_DIR;
+  c.rowPhase = R_HEAD;
+  c.rowCh    = (int8_t)ch;
+  c.rowIdx   = 0;
+}
+
+size_t LogWeb::produceDir(Conn& c, uint8_t* buf, size_t max) {
+  char* out = (char*)buf;
+  size_t n = 0;
+  const int ch = c.rowCh;
+  // canales: uno por línea con lo que ocupa (y su cuota, si tiene)
+  const bool chans = log_ && log_->channelCount() > 1;
+
+  if (c.rowPhase == R_HEAD) {
+    if (!putRow(out, n, max,
+                "<!doctype html><meta charset='utf-8'><title>Logs</title>"
+                "<style>body{font-family:system-ui,Arial;margin:16px} ul{line-height:1.8}</style>"
+                "<h2>Archivos en %s</h2>%s", c.dirPath, chans ? "<p>Canales: <a href='/fs'>todos</a>" : ""))
+      return 0;
+    c.rowPhase = chans ? R_ROWS : R_MID;
+  }
+  for (; c.rowPhase == R_ROWS; c.rowIdx++) {
+    size_t i = c.rowIdx;
+    if (i >= log_->channelCount()) { c.rowPhase = R_MID; c.rowIdx = 0; break; }
+    const char* cn = log_->channelName(i);
+    char quota[16] = "";
+    if (log_->channelQuota(i)) snprintf(quota, sizeof(quota), "/%lu", (unsigned long)log_->channelQuota(i));
+    if (!putRow(out, n, max, " · <a href='/fs?ch=%s'>%s%s%s</a> (%lu%s B)",
+                cn, (int)i == ch ? "<b>" : "", cn, (int)i == ch ? "</b>" : "",
+                (unsigned long)log_->channelBytes(i), quota) && n)
+      return n;
+  }
+  if (c.rowPhase == R_MID) {
+    if (!putRow(out, n, max, "%s<ul>", chans ? "</p>" : "")) return n;
+    c.rowPhase = R_LIST;
+  }
+
+  if (c.rowPhase == R_LIST && c.rowMan) {
+    for (; c.rowIdx < log_->segmentCount(); c.rowIdx++) {
+      const ClogFS::Segment& sg = log_->segment(c.rowIdx);
+      if (ch >= 0 && log_->channelOfFile(sg.name) != ch) continue;
+      char alerts[24] = "";
+      unsigned a = sg.sevCount[ClogFS::WARN] + sg.sevCount[ClogFS::ERROR] + sg.sevCount[ClogFS::CRIT];
+      if (a) snprintf(alerts, sizeof(alerts), " [WARN+=%u]", a);
+      if (!putRow(out, n, max,
+                  "<li><a href='/fs/download?path=%s'>%s</a> (%u B)%s — <a href='/fs/view?path=%s'>ver</a></li>",
+                  sg.name, sg.name, (unsigned)sg.size, alerts, sg.name) && n)
+        return n;
+    }
+    c.rowPhase = R_TAIL;
+  } else if (c.rowPhase == R_LIST) {
+    if (!c.file || !c.file.isDirectory()) {
+      if (!putRow(out, n, max, "<li><b>Directorio inválido</b></li></ul>")) return n;
+      c.rowPhase = R_DONE;
+      return n;
+    }
+    for (;;) {
+      if (!c.dirEnt) c.dirEnt = c.file.openNextFile();
+      if (!c.dirEnt) { c.rowPhase = R_TAIL; break; }
+      File& f = c.dirEnt;
+      const char* name = f.name();
+      bool fits = true;
+      if (strcmp(name, ClogFS::manifestName()) == 0) {
+        // no se lista
+      } else if (f.isDirectory()) {
+        fits = putRow(out, n, max, "<li>[DIR] <a href='/fs?path=%s/'>%s/</a></li>", name, name);
+      } else if (ch < 0 || log_->channelOfFile(name) == ch) {
+        fits = putRow(out, n, max,
+                      "<li><a href='/fs/download?path=%s'>%s</a> (%u B) — <a href='/fs/view?path=%s'>ver</a></li>",
+                      name, name, (unsigned)f.size(), name);
+      }
+      if (!fits && n) return n;                // la entrada espera al próximo tramo
+      c.dirEnt.close();
+    }
+  }
+
+  if (c.rowPhase == R_TAIL) {
+    const char* cn = ch >= 0 ? log_->channelName(ch) : nullptr;
+    if (putRow(out, n, max,
+               "</ul><p><a href='/fs/archive%s%s'>📦 Descargar %s (.tar)</a></p>"
+               "<p><a href='/fs/erase' onclick=\"return confirm('¿Borrar todos los logs?');\">🗑️ Borrar todos los logs</a></p>",
+               cn ? "?ch=" : "", cn ? cn : "", cn ? "canal" : "todos"))
+      c.rowPhase = R_DONE;
+  }
+  return n;
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
 // helpers
 // ─────────────────────────────────────────────────────────────────────────────
-String LogWeb::urlDecode(const String& src){
-  String dst; dst.reserve(src.length());
-  for (uint16_t i=0; i<src.length(); ++i){
-    char c = src[i];
-    if (c=='%' && i+2 < src.length()){
-      char h1 = src[i+1], h2 = src[i+2];
-      auto hex = [](char h)->int{
-        if(h>='0'&&h<='9') return h-'0';
-        if(h>='A'&&h<='F') return 10+(h-'A');
-        if(h>='a'&&h<='f') return 10+(h-'a');
-        return -1;
-      };
-      int v1 = hex(h1), v2 = hex(h2);
-      if (v1>=0 && v2>=0){ dst += char(v1*16+v2); i+=2; continue; }
-    }
-    if (c=='+') dst+=' '; else dst+=c;
-  }
-  return dst;
-}
-
-String LogWeb::sanitizePath(const String& raw, const String& base){
-  String p = urlDecode(raw);
-  String b = base;
-  if (!b.startsWith("/")) b = "/" + b;
-  if (!b.endsWith("/"))   b += "/";
-
-  if (p.isEmpty()) p = b;
-  if (!p.startsWith("/")) p = "/" + p;
-  p.replace("..","");
-
-  if (!p.startsWith(b)) {
-    String tail = p;
-    if (tail.startsWith("/")) tail.remove(0,1);
-    p = b + tail;
-  }
-  return p;
-}
-
-String LogWeb::renderDirHTML(const String& dirPath){
-  String html;
-  html += F("<!doctype html><meta charset='utf-8'><title>Logs</title>");
-  html += F("<style>body{font-family:system-ui,Arial;margin:16px} ul{line-height:1.8}</style>");
-  html += F("<h2>Archivos en ");
-  html += dirPath;
-  html += F("</h2><ul>");
-
-  File dir = LittleFS.open(dirPath, FILE_READ);
-  if (!dir || !dir.isDirectory()){
-    html += F("<li><b>Directorio inválido</b></li></ul>");
-    return html;
-  }
-
-  for (File f = dir.openNextFile(); f; f = dir.openNextFile()){
-    String name = f.name();
-    if (f.isDirectory()){
-      html += "<li>[DIR] <a href='/fs?path=" + name + "/'>" + name + "/</a></li>";
+// rotados (o todo, si el logger no tiene archivo abierto) no cambian más;
+// cada canal tiene su activo
+bool LogWeb::isImmutable(const char* name) const {
+  if (!log_) return webMode_;
+  if (!log_->fileOpen()) return true;
+  return !log_->isOpenFile(name);
+}
+
+// ?ch=<canal> → id; sin el parámetro, -1 (todos). Canal desconocido → 404
+bool LogWeb::queryChannel(Conn& c, const Req& r, int& ch) {
+  char arg[16];
+  ch = -1;
+  if (!queryArg(r, "ch", arg, sizeof(arg)) || !*arg) return true;
+  if (!log_ || (ch = log_->channel(arg)) < 0) {
+    sendText(c, 404, "text/plain", "unknown channel");
+    return false;
+  }
+  return true;
+}
+
+// "Sun, 14 Sep 2025 10:22:27 GMT"
+void LogWeb::httpDate(time_t t, char* out, size_t n){
+  struct tm tmv;
+  gmtime_r(&t, &tmv);
+  strftime(out, n, "%a, %d %b %Y %H:%M:%S GMT", &tmv);
+}
+
+time_t LogWeb::parseHttpDate(const char* s, size_t n){
+  char buf[40], mon[4];
+  if (n >= sizeof(buf)) n = sizeof(buf) - 1;
+  memcpy(buf, s, n);
+  buf[n] = 0;
+  int d, y, h, mi, se;
+  if (sscanf(buf, "%*3s, %d %3s %d %d:%d:%d", &d, mon, &y, &h, &mi, &se) != 6) return 0;
+  static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+  const char* p = strstr(months, mon);
+  if (!p) return 0;
+  int m = (p - months) / 3 + 1;
+
+  // días desde 1970-01-01 (calendario civil, sin depender de timegm)
+  y -= (m <= 2);
+  int era = (y >= 0 ? y : y - 399) / 400;
+  unsigned yoe = (unsigned)(y - era * 400);
+  unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  long days = era * 146097L + (long)doe - 719468L;
+  return (time_t)(days * 86400L + h * 3600L + mi * 60L + se);
+}
+
+// If-None-Match: lista separada por comas; "*" solo, o una etiqueta igual
+// a etag (con comillas), con o sin W/ (comparación débil)
+bool LogWeb::etagMatch(const char* inm, size_t n, const char* etag){
+  size_t el = strlen(etag);
+  const char* p = inm;
+  const char* end = inm + n;
+  while (p < end) {
+    const char* q = (const char*)memchr(p, ',', end - p);
+    if (!q) q = end;
+    const char* a = p;
+    const char* b = q;
+    while (a < b && (*a == ' ' || *a == '\t')) ++a;
+    while (b > a && (b[-1] == ' ' || b[-1] == '\t')) --b;
+    if (b - a == 1 && *a == '*') return true;
+    if (b - a >= 2 && a[0] == 'W' && a[1] == '/') a += 2;
+    if ((size_t)(b - a) == el && memcmp(a, etag, el) == 0) return true;
+    p = q + 1;
+  }
+  return false;
+}
+
+// manifest del logger sólo si está montado y es su misma base
+bool LogWeb::useManifest(const String& dirPath) const {
+  return log_ && log_->manifestReady() && dirPath == basePath_;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// /fs/archive helpers
+// ─────────────────────────────────────────────────────────────────────────────
+
+// glob simple: '*' y '?'
+bool LogWeb::globMatch(const char* pat, const char* s){
+  const char* star = nullptr;
+  const char* back = nullptr;
+  while (*s) {
+    if (*pat == '?' || *pat == *s) { ++pat; ++s; continue; }
+    if (*pat == '*') { star = pat++; back = s; continue; }
+    if (star) { pat = star + 1; s = ++back; continue; }
+    return false;
+  }
+  while (*pat == '*') ++pat;
+  return *pat == 0;
+}
+
+// ventana temporal por nombre: "<canal>-YYYYMMDD-HHMMSS.txt" → "YYYYMMDD-HHMMSS"
+// from/to pueden ser prefijos ("20250913" incluye todo ese día)
+bool LogWeb::archiveSelect(const char* name, const char* from,
+                           const char* to, const char* glob){
+  if (*glob && !globMatch(glob, name)) return false;
+  if (!*from && !*to) return true;
+
+  const char* dash = strchr(name, '-');
+  if (!dash || strlen(dash + 1) < 15) return false;
+  const char* stamp = dash + 1;                 // 15 chars
+  if (*from && strncmp(stamp, from, 15) < 0) return false;
+  size_t tl = strlen(to);
+  if (*to && strncmp(stamp, to, tl < 15 ? tl : 15) > 0) return false;
+  return true;
+}
+
+// cabecera ustar de 512 bytes
+// campo octal de tar: digits cifras con ceros a la izquierda + '\0'
+// (lo que no entra queda en el máximo del campo)
+static void tarOctal(char* dst, int digits, unsigned long v){
+  for (int i = digits - 1; i >= 0; --i) {
+    dst[i] = (char)('0' + (v & 7));
+    v >>= 3;
+  }
+  if (v) memset(dst, '7', digits);
+  dst[digits] = 0;
+}
+
+void LogWeb::tarHeader(uint8_t* hdr, const char* name, size_t size, time_t mtime){
+  memset(hdr, 0, 512);
+  char* h = (char*)hdr;
+  strncpy(h, name, 99);                                // name
+  memcpy (h + 100, "0000644", 8);                              // mode
+  memcpy (h + 108, "0000000", 8);                              // uid
+  memcpy (h + 116, "0000000", 8);                              // gid
+  tarOctal(h + 124, 11, (unsigned long)size);                  // size
+  tarOctal(h + 136, 11, (unsigned long)(mtime > 0 ? mtime : 0)); // mtime
+  memset (h + 148, ' ', 8);                                    // chksum (provisorio)
+  h[156] = '0';                                                // typeflag: archivo
+  memcpy (h + 257, "ustar", 6);                                // magic
+  memcpy (h + 263, "00", 2);                                   // version
+
+  unsigned sum = 0;
+  for (int i = 0; i < 512; ++i) sum += hdr[i];
+  tarOctal(h + 148, 6, sum);                                   // 6 oct + '\0' + ' '
+  h[155] = ' ';
+}
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// /ts: series de tiempo de ClogTS, en streaming
+// ─────────────────────────────────────────────────────────────────────────────
+//   /ts                                   → canales (JSON)
+//   /ts?ch=temp&from=-7d&to=now&res=1h&fmt=json|csv
+// from/to: epoch, YYYYMMDD[-HHMMSS] (hora local) o relativo (-90m, -6h, -7d).
+// res: raw|1m|1h; sin res se elige por rango (≤6 h raw, ≤7 d 1m, si no 1h).
+// Los rollups se leen tal cual del archivo: no se decodifica lo crudo.
+void LogWeb::handleTs(Conn& c, const Req& r) {
+  if (!ts_) { sendText(c, 503, "text/plain", "time series off"); return; }
+
+  char arg[24];
+  if (!queryArg(r, "ch", arg, sizeof(arg)) || !*arg) {
+    String body = F("{\"channels\":[");
+    for (size_t i = 0; i < ts_->channelCount(); ++i) {
+      char item[128];
+      JsonWriter w(item, sizeof(item));
+      if (i) w.ch(',');
+      w.raw("{").key("name").str(ts_->channelName(i))
+       .key("scale").f64(ts_->channelScale(i))
+       .key("samples").u64(ts_->channelSamples(i)).ch('}');
+      body.concat(w.c_str(), w.length());
+    }
+    body += F("],\"res\":[\"raw\",\"1m\",\"1h\"]}");
+    sendText(c, 200, "application/json", body, "Cache-Control: no-store\r\n");
+    return;
+  }
+  int ch = ts_->channel(arg);
+  if (ch < 0) { sendText(c, 404, "text/plain", "unknown channel"); return; }
+
+  time_t now  = ts_->now();
+  time_t to   = queryArg(r, "to", arg, sizeof(arg))   ? parseWhen(arg, now) : now;
+  time_t from = queryArg(r, "from", arg, sizeof(arg)) ? parseWhen(arg, now) : to - 86400;
+  if (from <= 0 || to <= 0 || to < from) { sendText(c, 400, "text/plain", "bad range"); return; }
+
+  ClogTS::Res res;
+  if (queryArg(r, "res", arg, sizeof(arg))) {
+    if (!ClogTS::resFromName(arg, &res)) { sendText(c, 400, "text/plain", "res: raw|1m|1h"); return; }
+  } else {
+    time_t span = to - from;
+    res = (span <= 6 * 3600) ? ClogTS::RES_RAW : (span <= 7 * 86400) ? ClogTS::RES_MIN : ClogTS::RES_HOUR;
+  }
+  bool json = queryArg(r, "fmt", arg, sizeof(arg)) && strcmp(arg, "json") == 0;
+
+  if (!ts_->open(c.tsCur, ch, res, from, to)) { sendText(c, 400, "text/plain", "bad range"); return; }
+
+  // decimales según la escala (0.01 → 2)
+  float sc = ts_->channelScale(ch);
+  uint8_t dec = 0;
+  while (dec < 6 && sc < 0.999f) { sc *= 10; ++dec; }
+
+  beginResponse(c, 200, json ? "application/json" : "text/csv; charset=utf-8", (size_t)-1,
+                "Cache-Control: no-store\r\n");
+  c.kind    = B_TS;
+  c.tsPhase = 0;
+  c.tsDec   = dec;
+  c.tsJson  = json;
+  c.tsFirst = true;
+  c.tsHeld  = false;
+}
+
+// prefijo, puntos de a tramos, sufijo; crudo: t,v / rollup: t,min,max,avg,n
+size_t LogWeb::produceTs(Conn& c, uint8_t* buf, size_t max) {
+  char* out = (char*)buf;
+  size_t n = 0;
+  bool raw = (c.tsCur.res == ClogTS::RES_RAW);
+
+  if (c.tsPhase == 0) {
+    if (c.tsJson) {
+      JsonWriter w(out, max);
+      w.raw("{").key("ch").str(ts_->channelName(c.tsCur.ch))
+       .key("res").str(ClogTS::resName((ClogTS::Res)c.tsCur.res))
+       .key("from").u64(c.tsCur.from).key("to").u64(c.tsCur.to)
+       .key("cols").raw(raw ? "[\"t\",\"v\"]" : "[\"t\",\"min\",\"max\",\"avg\",\"n\"]")
+       .key("points").ch('[');
+      n += w.length();
     } else {
-      html += "<li><a href='/fs/download?path=" + name + "'>" + name + "</a>";
-      html += " (" + String((unsigned)f.size()) + " B)";
-      html += " — <a href='/fs/view?path=" + name + "'>ver</a>";
-      html += "</li>";
+      int k = snprintf(out, max, "%s\n", raw ? "t,v" : "t,min,max,avg,n");
+      n += (k > 0 && (size_t)k < max) ? (size_t)k : 0;
     }
+    c.tsPhase = 1;
   }
-   html += "</ul>";
-  html += "<p>"
-          "<a href='/fs/erase' onclick=\"return confirm('¿Borrar todos los logs?');\">🗑️ Borrar todos los logs</a>"
-          "</p>";
 
+  // cada fila se arma aparte: el ancho de %.*f depende de la escala y del
+  // valor. Si no entra en lo que queda, el punto espera al próximo tramo
+  while (c.tsPhase == 1) {
+    ClogTS::Point& p = c.tsPt;
+    if (!c.tsHeld && !ts_->next(c.tsCur, p)) { c.tsPhase = 2; break; }
+    c.tsHeld = false;
+    const char* sep = c.tsJson ? (c.tsFirst ? "[" : ",[") : "";
+    const char* end = c.tsJson ? "]" : "\n";
+    int d = c.tsDec;
+    char row[192];
+    int k = raw ? snprintf(row, sizeof(row), "%s%lu,%.*f%s", sep, (unsigned long)p.t, d, (double)p.avg, end)
+                : snprintf(row, sizeof(row), "%s%lu,%.*f,%.*f,%.*f,%u%s", sep, (unsigned long)p.t,
+                           d, (double)p.min, d, (double)p.max, d, (double)p.avg, (unsigned)p.n, end);
+    if (k <= 0 || (size_t)k >= sizeof(row)) continue;   // valor absurdo: la fila se omite
+    if ((size_t)k > max - n) { c.tsHeld = true; break; }
+    memcpy(out + n, row, (size_t)k);
+    n += (size_t)k;
+    c.tsFirst = false;
+  }
 
-  return html;
+  if (c.tsPhase == 2) {
+    if (!c.tsJson) c.tsPhase = 3;
+    else if (max - n >= 3) { memcpy(out + n, "]}\n", 3); n += 3; c.tsPhase = 3; }
+  }
+  return n;
+}
+
+// epoch | YYYYMMDD[-HHMMSS] local | -N[s|m|h|d] relativo a now | "now"
+time_t LogWeb::parseWhen(const char* s, time_t now) {
+  if (!s || !*s) return 0;
+  if (strcmp(s, "now") == 0) return now;
+  if (*s == '-') {
+    char* e;
+    long v = strtol(s + 1, &e, 10);
+    long mul = (*e == 'm') ? 60 : (*e == 'h') ? 3600 : (*e == 'd') ? 86400 : 1;
+    return now - (time_t)v * mul;
+  }
+  size_t n = strlen(s);
+  if ((n == 8 || (n == 15 && s[8] == '-'))) {
+    int Y, M, D, h = 0, mi = 0, se = 0;
+    if (sscanf(s, "%4d%2d%2d", &Y, &M, &D) != 3) return 0;
+    if (n == 15 && sscanf(s + 9, "%2d%2d%2d", &h, &mi, &se) != 3) return 0;
+    struct tm tmv = {};
+    tmv.tm_year = Y - 1900; tmv.tm_mon = M - 1; tmv.tm_mday = D;
+    tmv.tm_hour = h; tmv.tm_min = mi; tmv.tm_sec = se;
+    tmv.tm_isdst = -1;
+    return mktime(&tmv);
+  }
+  return (time_t)strtoul(s, nullptr, 10);
 }
@@ -3,7 +3,27 @@
 
 #include <Arduino.h>
 #include <LittleFS.h>
-#include <WebServer.h>
+#include <WiFi.h>
+#include <vector>
+#include "ClogFS.h"
+#include "ClogTS.h"
+
+// Servidor HTTP propio, no bloqueante: varias conexiones atendidas por
+// turnos en loop(), cada una con un buffer fijo para request + cabecera
+// de respuesta y otro para el tramo del cuerpo que el socket todavía no
+// aceptó. El parseo del request no usa heap.
+#ifndef LOGWEB_MAX_CLIENTS
+#define LOGWEB_MAX_CLIENTS 4        // conexiones simultáneas
+#endif
+#ifndef LOGWEB_IO_BYTES
+#define LOGWEB_IO_BYTES    768      // request (línea + headers) / cabecera de respuesta
+#endif
+#ifndef LOGWEB_CHUNK
+#define LOGWEB_CHUNK       1460     // bytes por conexión y por vuelta de loop()
+#endif
+#ifndef LOGWEB_IDLE_MS
+#define LOGWEB_IDLE_MS     10000
+#endif
 
 class LogWeb {
 public:
@@ -17,17 +37,116 @@ public:
   bool inWebMode() const { return webMode_; }
 
   void setBasePath(const String& base);
+  void setLogger(ClogFS* log) { log_ = log; }   // opcional: usa su manifest
+  void setTimeSeries(ClogTS* ts) { ts_ = ts; }  // opcional: habilita /ts
 
 private:
-  void setupEndpoints();
-  String urlDecode(const String& src);
-  String sanitizePath(const String& raw, const String& base);
-  String renderDirHTML(const String& dirPath);
+  enum ConnState : uint8_t { C_FREE, C_READ, C_SEND };
+  enum BodyKind  : uint8_t { B_NONE, B_MEM, B_FILE, B_ARCHIVE, B_TS, B_FRAMED,
+                             B_RECENT, B_CHANNELS, B_DIR };
+  enum ArcPhase  : uint8_t { A_HEADER, A_BODY, A_PAD, A_TRAILER, A_DONE };
+  enum RowPhase  : uint8_t { R_HEAD, R_ROWS, R_MID, R_LIST, R_TAIL, R_DONE };
+  enum FrPhase   : uint8_t { F_SCAN, F_VERIFY, F_EMIT, F_MARK, F_DONE };
+
+  // request parseado en el lugar: punteros dentro de Conn::io
+  struct Req {
+    const char* path;  size_t pathLen;
+    const char* query; size_t queryLen;
+    const char* inm;   size_t inmLen;     // If-None-Match
+    const char* ims;   size_t imsLen;     // If-Modified-Since
+    bool        get;
+  };
+
+  struct Conn {
+    WiFiClient client;
+    ConnState  st;
+    BodyKind   kind;
+    uint32_t   tLast;
+    char       io[LOGWEB_IO_BYTES];
+    uint16_t   ioLen, ioSent;
+    uint8_t    out[LOGWEB_CHUNK];   // tramo del cuerpo (lo no enviado espera acá)
+    uint16_t   outLen, outSent;
+    // cuerpo
+    String     mem;      size_t memSent;
+    File       file;     size_t fileLeft;
+    std::vector<String> arcNames;
+    size_t     arcIdx, arcLeft, arcPad;
+    ArcPhase   arcPhase;
+    ClogTS::Cursor tsCur;
+    uint8_t    tsPhase, tsDec;
+    bool       tsJson, tsFirst, tsHeld;
+    ClogTS::Point tsPt;            // punto leído que no entró en el tramo
+    // /fs/view: bloques verificados contra su trailer
+    FrPhase    frPhase;
+    bool       frMid, frOk, frJson;
+    uint32_t   frSize, frPos, frRegion, frEmit, frEmitEnd, frNext, frCrc, frWant;
+    // /fs/recent, /fs/channels, /fs: de a filas enteras; la que no entra
+    // en el tramo se arma de nuevo en el siguiente
+    RowPhase   rowPhase;
+    bool       rowJson, rowFirst, rowMan;
+    int8_t     rowCh;
+    size_t     rowIdx;
+    ClogFS::RecentCursor rcCur;
+    File       dirEnt;             // entrada leída que no entró en el tramo
+    char       dirPath[96];
+  };
+
+  // conexiones
+  void   accept();
+  void   service(Conn& c);
+  void   closeConn(Conn& c);
+  size_t produce(Conn& c, uint8_t* buf, size_t max);
+  int    sendSome(Conn& c, const uint8_t* p, size_t n);
+  size_t produceArchive(Conn& c, uint8_t* buf, size_t max);
+  size_t produceTs(Conn& c, uint8_t* buf, size_t max);
+  size_t produceFramed(Conn& c, uint8_t* buf, size_t max);
+  size_t produceRecent(Conn& c, uint8_t* buf, size_t max);
+  size_t produceChannels(Conn& c, uint8_t* buf, size_t max);
+  size_t produceDir(Conn& c, uint8_t* buf, size_t max);
+
+  // request / respuesta
+  static bool parseRequest(char* io, size_t len, Req& r);
+  static bool pathIs(const Req& r, const char* p);
+  static bool queryArg(const Req& r, const char* key, char* out, size_t outLen);
+  static size_t urlDecode(const char* src, size_t n, char* dst, size_t dstLen);
+  void   sanitizePath(const char* raw, char* out, size_t outLen) const;
+  void   beginResponse(Conn& c, int code, const char* type, size_t len, const char* extra = nullptr);
+  void   sendText(Conn& c, int code, const char* type, const String& body, const char* extra = nullptr);
+
+  // endpoints
+  void   handle(Conn& c, const Req& r);
+  void   handleErase(Conn& c);
+  void   handleFile(Conn& c, const Req& r, bool download);
+  void   handleRecent(Conn& c, const Req& r);
+  void   handleChannels(Conn& c);
+  void   handleDir(Conn& c, const char* path, int ch);
+  void   handleArchive(Conn& c, const Req& r);
+  void   handleTs(Conn& c, const Req& r);
+
+  bool   useManifest(const String& dirPath) const;
+  bool   isImmutable(const char* name) const;
+  bool   queryChannel(Conn& c, const Req& r, int& ch);
+  static void httpDate(time_t t, char* out, size_t n);
+  static time_t parseHttpDate(const char* s, size_t n);
+  static bool etagMatch(const char* inm, size_t n, const char* etag);
+
+  // /fs/archive (tar en streaming)
+  static bool globMatch(const char* pat, const char* s);
+  static bool archiveSelect(const char* name, const char* from,
+                            const char* to, const char* glob);
+  static void tarHeader(uint8_t* hdr, const char* name, size_t size, time_t mtime);
+
+  // /ts (series de tiempo)
+  static time_t parseWhen(const char* s, time_t now);
 
   uint16_t   port_;
   String     basePath_;
-  WebServer  server_;
+  WiFiServer server_;
+  Conn       conns_[LOGWEB_MAX_CLIENTS];
   bool       webMode_;
+  bool       started_;
+  ClogFS*    log_;
+  ClogTS*    ts_;
 };
 
 #endif // LOGWEB_H
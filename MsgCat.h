@@ -110,6 +110,43 @@ namespace Msg {
   inline const __FlashStringHelper* INIT_ZONA_LUX_FAIL()  { return F("Init zona lux: lectura inválida"); }
   inline const __FlashStringHelper* NTP_SYNC_WIFI_FAIL_ERR(){ return F("Falló wifi en sincronización NTP"); }
 
+  // -------------------------------------------------------------------
+  // ID / nombre por formato (salida JSON). El ID es la posición en la
+  // tabla: agregar mensajes nuevos siempre al final.
+  // -------------------------------------------------------------------
+  struct Entry { const char* name; const __FlashStringHelper* (*fmt)(); };
+
+  inline const char* nameOf(const __FlashStringHelper* fmt, int* id = nullptr) {
+    static const Entry table[] = {
+      { "APP_START", APP_START }, { "LOOP_BANNER", LOOP_BANNER }, { "HEARTBEAT", HEARTBEAT },
+      { "PROJECT_NAME", PROJECT_NAME }, { "FW_VERSION", FW_VERSION }, { "FS_MOUNT_OK", FS_MOUNT_OK },
+      { "FS_MOUNT_FAIL", FS_MOUNT_FAIL }, { "FS_LIST_FILE", FS_LIST_FILE }, { "FS_DIR_EMPTY", FS_DIR_EMPTY },
+      { "FS_WIPE_START", FS_WIPE_START }, { "FS_WIPE_DONE", FS_WIPE_DONE }, { "FS_STATS", FS_STATS },
+      { "LOG_ROTATED", LOG_ROTATED }, { "LOG_FILE_CREATED", LOG_FILE_CREATED }, { "LOG_FILE_FAIL", LOG_FILE_FAIL },
+      { "LOG_LOW_WATER", LOG_LOW_WATER }, { "LOG_BURST_START", LOG_BURST_START }, { "LOG_BURST_ITEM", LOG_BURST_ITEM },
+      { "WIFI_CONN_TRY", WIFI_CONN_TRY }, { "WIFI_CONN_OK", WIFI_CONN_OK }, { "WIFI_CONN_TIMEOUT", WIFI_CONN_TIMEOUT },
+      { "WIFI_AP_MODE", WIFI_AP_MODE }, { "NTP_SYNC_TRY", NTP_SYNC_TRY }, { "NTP_SYNC_OK", NTP_SYNC_OK },
+      { "NTP_SYNC_FAIL", NTP_SYNC_FAIL }, { "NTP_SYNC_WIFI_FAIL", NTP_SYNC_WIFI_FAIL }, { "WEB_SERVER_START", WEB_SERVER_START },
+      { "WEB_SERVER_ON", WEB_SERVER_ON }, { "WEB_SERVER_OFF", WEB_SERVER_OFF }, { "CFG_ENTER", CFG_ENTER },
+      { "CFG_EXIT_NEW", CFG_EXIT_NEW }, { "CFG_EXIT_FAIL", CFG_EXIT_FAIL }, { "TIMER_SENSORS_START", TIMER_SENSORS_START },
+      { "SENSOR_OK", SENSOR_OK }, { "SENSOR_INIT", SENSOR_INIT }, { "SENSOR_VALUE", SENSOR_VALUE },
+      { "MODE_CFG", MODE_CFG }, { "MODE_RUNTIME", MODE_RUNTIME }, { "BOOT_MSG", BOOT_MSG },
+      { "EDGENT_BEGIN", EDGENT_BEGIN }, { "EDGENT_WIFI_WAIT", EDGENT_WIFI_WAIT }, { "NTP_WAITING", NTP_WAITING },
+      { "CFG_EXIT_TO_APP", CFG_EXIT_TO_APP }, { "NTP_NOT_SYNCED", NTP_NOT_SYNCED }, { "SENSOR_INVALID", SENSOR_INVALID },
+      { "BME280_INVALID", BME280_INVALID }, { "TSL2561_INVALID", TSL2561_INVALID }, { "NTP_SYNC_FAIL_WARN", NTP_SYNC_FAIL_WARN },
+      { "INIT_IS_DAY_POST_NTP", INIT_IS_DAY_POST_NTP }, { "ISDAY_STATUS", ISDAY_STATUS }, { "ISDAY_CHANGE", ISDAY_CHANGE },
+      { "INIT_ZONA_TEMP", INIT_ZONA_TEMP }, { "INIT_ZONA_HUM", INIT_ZONA_HUM }, { "INIT_ZONA_VPD", INIT_ZONA_VPD },
+      { "INIT_ZONA_LUX", INIT_ZONA_LUX }, { "BME280_LINE", BME280_LINE }, { "V100_TEMP_SENT", V100_TEMP_SENT },
+      { "BME280_ERROR", BME280_ERROR }, { "TSL2561_ERROR", TSL2561_ERROR }, { "NTP_TIMEOUT", NTP_TIMEOUT },
+      { "INIT_ZONA_TEMP_FAIL", INIT_ZONA_TEMP_FAIL }, { "INIT_ZONA_HUM_FAIL", INIT_ZONA_HUM_FAIL }, { "INIT_ZONA_LUX_FAIL", INIT_ZONA_LUX_FAIL },
+      { "NTP_SYNC_WIFI_FAIL_ERR", NTP_SYNC_WIFI_FAIL_ERR },
+    };
+    for (size_t i = 0; i < sizeof(table) / sizeof(table[0]); ++i) {
+      if (table[i].fmt() == fmt) { if (id) *id = (int)i; return table[i].name; }
+    }
+    return nullptr;
+  }
+
 } // namespace Msg
 
 #endif // MSG_CAT_H
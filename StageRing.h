@@ -0,0 +1,72 @@
+// StageRing.h — ring de bytes para el staging y la caché reciente de ClogFS.
+// Sin dependencias de Arduino: la memoria la pone el llamador (PSRAM en
+// ESP32-S3, malloc común en un host Linux). Sin locks: ClogFS los maneja.
+#ifndef STAGE_RING_H
+#define STAGE_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+class StageRing {
+public:
+  StageRing() : _buf(nullptr), _cap(0), _head(0), _tail(0), _used(0) {}
+
+  void attach(uint8_t* mem, size_t cap) { _buf = mem; _cap = mem ? cap : 0; clear(); }
+  uint8_t* detach() { uint8_t* m = _buf; _buf = nullptr; _cap = 0; clear(); return m; }
+  void clear() { _head = _tail = _used = 0; }
+
+  size_t capacity() const { return _cap; }
+  size_t used()     const { return _used; }
+  size_t room()     const { return _cap - _used; }
+
+  // todo o nada
+  bool push(const void* src, size_t n) {
+    if (n > room()) return false;
+    const uint8_t* p = (const uint8_t*)src;
+    size_t first = _cap - _head;
+    if (first > n) first = n;
+    memcpy(_buf + _head, p, first);
+    memcpy(_buf, p + first, n - first);
+    _head = (_head + n) % _cap;
+    _used += n;
+    return true;
+  }
+
+  // hasta max bytes, en orden
+  size_t pop(uint8_t* dst, size_t max) {
+    size_t n = (_used < max) ? _used : max;
+    size_t first = _cap - _tail;
+    if (first > n) first = n;
+    memcpy(dst, _buf + _tail, first);
+    memcpy(dst + first, _buf, n - first);
+    _tail = _cap ? (_tail + n) % _cap : 0;
+    _used -= n;
+    return n;
+  }
+
+  // lectura sin consumir, desde el más viejo + offset
+  size_t peek(uint8_t* dst, size_t n, size_t offset = 0) const {
+    if (offset >= _used) return 0;
+    if (n > _used - offset) n = _used - offset;
+    size_t start = (_tail + offset) % _cap;
+    size_t first = _cap - start;
+    if (first > n) first = n;
+    memcpy(dst, _buf + start, first);
+    memcpy(dst + first, _buf, n - first);
+    return n;
+  }
+
+  void drop(size_t n) {
+    if (n > _used) n = _used;
+    _tail = _cap ? (_tail + n) % _cap : 0;
+    _used -= n;
+  }
+
+private:
+  uint8_t* _buf;
+  size_t   _cap;
+  size_t   _head, _tail, _used;
+};
+
+#endif // STAGE_RING_H
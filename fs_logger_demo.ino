@@ -5,6 +5,7 @@
 
 #include "RtcNtp.h"
 #include "ClogFS.h"
+#include "ClogTS.h"
 #include "LogWeb.h"
 #include "MsgCat.h"
 
@@ -19,8 +20,15 @@ static const char* FW_VERSION  = "demo-7.6"; //level
 // Instancias
 RtcNtp  Rtc;
 ClogFS  Log;
+ClogTS  Ts;        // series de tiempo (/ts)
 LogWeb  logWeb(80, "/");
 
+// canales de series de tiempo
+static int g_ts_heap = -1, g_ts_rssi = -1;
+
+// canales de log (0 = "log", el de siempre)
+static int g_ch_sensors = 0, g_ch_audit = 0;
+
 // Flags
 volatile bool g_logging_enabled = true;
 
@@ -64,6 +72,7 @@ static bool canWriteLogs() {
 
 // Modo CFG
 static void enter_cfg_mode() {
+  Log.log(g_ch_audit, ClogFS::INFO, F("cfg on"));
   Log.closeFile();
   g_logging_enabled = false;
   logWeb.enterWebMode();
@@ -72,7 +81,7 @@ static void enter_cfg_mode() {
 
 static void exit_cfg_mode() {
   time_t now = Rtc.isSynced() ? Rtc.now() : time(nullptr);
-  String fresh  = ClogFS::makeFilename(now);
+  String fresh  = ClogFS::makeFilename(now, Log.fileExt());
   String header = String("VERSION=") + FW_VERSION +
                   " MOTIVO_RESET=CFG_EXIT IP=" + WiFi.localIP().toString();
 
@@ -83,6 +92,7 @@ static void exit_cfg_mode() {
   }
   g_logging_enabled = true;
   logWeb.exitWebMode();
+  Log.log(g_ch_audit, ClogFS::INFO, F("cfg off"));
 }
 
 static void handleSerialCommands(){
@@ -104,6 +114,7 @@ static void handleSerialCommands(){
     } else {
       bool ok = LittleFS.format();
       Serial.printf("format: %s\n", ok ? "OK" : "FAIL");
+      Log.log(g_ch_audit, ClogFS::WARN, F("fs format %s"), ok ? "OK" : "FAIL");
     }
 
   } else if (line.equalsIgnoreCase("rot try")) {
@@ -135,6 +146,103 @@ static void handleSerialCommands(){
       Serial.printf("nuevo fsLowWater = %u bytes\n", (unsigned)val);
     }
 
+  } else if (line.startsWith("log stage")) {
+    String arg = line.substring(String("log stage").length());
+    arg.trim();
+
+    if (arg.equalsIgnoreCase("off")) {
+      Log.disableStaging();
+    } else if (arg.length() > 0) {
+      int kb = arg.toInt();
+      if (kb <= 0) {
+        Serial.println(F("uso: log stage [KB|off]  (ej: log stage 2048)"));
+        return;
+      }
+      bool ok = Log.enableStaging((size_t)kb * 1024);
+      Serial.printf("stage: %s (%d KB)\n", ok ? "ON" : "FAIL", kb);
+    }
+
+    if (Log.stagingEnabled()) {
+      ClogFS::StageStats st = Log.stagingStats();
+      Serial.printf("stage: cap=%u used=%u peak=%u psram=%d stalls=%u dropped=%u\n",
+                    (unsigned)st.capacity, (unsigned)st.used, (unsigned)st.peakUsed,
+                    (int)st.inPsram, (unsigned)st.stalls, (unsigned)st.dropped);
+      Serial.printf("stage: in=%lluB out=%lluB avg=%uB/s peak=%uB/s\n",
+                    (unsigned long long)st.ingested, (unsigned long long)st.drained,
+                    (unsigned)st.avgBps, (unsigned)st.peakBps);
+    } else {
+      Serial.println(F("stage: off"));
+    }
+
+  } else if (line.startsWith("log shed")) {
+    // marcas de descarte (en % de llenado): log shed <trace> <debug> <info>
+    String arg = line.substring(String("log shed").length());
+    arg.trim();
+    if (arg.length() > 0) {
+      int sp1 = arg.indexOf(' ');
+      int sp2 = (sp1 >= 0) ? arg.indexOf(' ', sp1 + 1) : -1;
+      if (sp2 < 0) {
+        Serial.println(F("uso: log shed [trace% debug% info%]  (ej: log shed 50 70 85)"));
+        return;
+      }
+      Log.setShedWatermarks((uint8_t)arg.substring(0, sp1).toInt(),
+                            (uint8_t)arg.substring(sp1 + 1, sp2).toInt(),
+                            (uint8_t)arg.substring(sp2 + 1).toInt());
+    }
+    Serial.printf("shed: fill=%u%% TRACE=%lu DEBUG=%lu INFO=%lu\n",
+                  (unsigned)Log.bufferFillPct(),
+                  (unsigned long)Log.shedCount(ClogFS::TRACE),
+                  (unsigned long)Log.shedCount(ClogFS::DEBUG),
+                  (unsigned long)Log.shedCount(ClogFS::INFO));
+
+  } else if (line.startsWith("log format")) {
+    // formato de salida: log format text|json [serial|file]  (sin destino = ambos)
+    String arg = line.substring(String("log format").length());
+    arg.trim();
+    if (arg.length() > 0) {
+      int sp = arg.indexOf(' ');
+      String fmt  = (sp >= 0) ? arg.substring(0, sp) : arg;
+      String sink = (sp >= 0) ? arg.substring(sp + 1) : String("");
+      sink.trim();
+      ClogFS::Format f;
+      if      (fmt.equalsIgnoreCase("text")) f = ClogFS::FMT_TEXT;
+      else if (fmt.equalsIgnoreCase("json")) f = ClogFS::FMT_JSONL;
+      else {
+        Serial.println(F("uso: log format [text|json] [serial|file]"));
+        return;
+      }
+      if (sink.length() == 0 || sink.equalsIgnoreCase("serial")) Log.setSerialFormat(f);
+      if (sink.length() == 0 || sink.equalsIgnoreCase("file"))   Log.setFileFormat(f);
+    }
+    Serial.printf("format: serial=%s file=%s (archivo nuevo: *%s)\n",
+                  Log.serialFormat() == ClogFS::FMT_JSONL ? "json" : "text",
+                  Log.fileFormat()   == ClogFS::FMT_JSONL ? "json" : "text",
+                  Log.fileExt());
+
+  } else if (line.startsWith("log sample")) {
+    // muestreo del item de 'log burst' (1 de cada N / a lo sumo 1 cada ms)
+    String arg = line.substring(String("log sample").length());
+    arg.trim();
+
+    if (arg.equalsIgnoreCase("off")) {
+      Log.clearSampling(Msg::LOG_BURST_ITEM());
+    } else if (arg.startsWith("every ")) {
+      Log.sampleEvery(Msg::LOG_BURST_ITEM(), (uint16_t)arg.substring(6).toInt());
+    } else if (arg.startsWith("ms ")) {
+      Log.sampleInterval(Msg::LOG_BURST_ITEM(), (uint32_t)arg.substring(3).toInt());
+    } else if (arg.length() > 0) {
+      Serial.println(F("uso: log sample [every N|ms T|off]"));
+      return;
+    }
+
+    if (Log.sampleSiteCount() == 0) Serial.println(F("sample: sin sitios"));
+    for (size_t i = 0; i < Log.sampleSiteCount(); ++i) {
+      const ClogFS::SampleSite& ss = Log.sampleSite(i);
+      Serial.printf("sample: every=%u ms=%lu seen=%lu written=%lu fmt=\"%.32s\"\n",
+                    (unsigned)ss.every, (unsigned long)ss.intervalMs,
+                    (unsigned long)ss.seen, (unsigned long)ss.written, (PGM_P)ss.fmt);
+    }
+
   } else if (line.startsWith("log burst")) {
     if (!canWriteLogs()) return;
 
@@ -153,10 +261,18 @@ static void handleSerialCommands(){
     String payload = makePayload(sz);
     Serial.printf("log burst: N=%d size=%d\n", N, sz);
     for (int i = 1; i <= N; ++i) {
-      Log.info(F("spam: i=%d/%d %s"), i, N, payload.c_str());
+      Log.info(Msg::LOG_BURST_ITEM(), i, N, payload.c_str());
       delay(1);
     }
 
+  } else if (line.equalsIgnoreCase("ts")) {
+    // canales de series de tiempo (consultar por web: /ts?ch=heap&from=-1d)
+    Ts.flush();
+    for (size_t i = 0; i < Ts.channelCount(); ++i) {
+      Serial.printf("ts: %s scale=%g samples=%lu\n", Ts.channelName(i),
+                    (double)Ts.channelScale(i), (unsigned long)Ts.channelSamples(i));
+    }
+
   } else if (line.equalsIgnoreCase("fs stats")) {
     size_t total = LittleFS.totalBytes();
     size_t used  = LittleFS.usedBytes();
@@ -189,6 +305,52 @@ static void handleSerialCommands(){
     Log.setMinSeverity(s);
     Serial.printf("log level = %s\n", ClogFS::sevName(s));
 
+  } else if (line.startsWith("log ch")) {
+    // log ch                    → lista
+    // log ch <nombre> <nivel>   → umbral del canal
+    // log ch <nombre> quota KB  → cuota (rota cada KB/4; "log" no rota)
+    String arg = line.substring(String("log ch").length());
+    arg.trim();
+    if (arg.length() == 0) {
+      for (size_t i = 0; i < Log.channelCount(); ++i) {
+        Serial.printf("ch %-8s %-5s quota=%lu max=%lu bytes=%lu\n", Log.channelName(i),
+                      ClogFS::sevName(Log.channelMinSeverity(i)),
+                      (unsigned long)Log.channelQuota(i), (unsigned long)Log.channelMaxFile(i),
+                      (unsigned long)Log.channelBytes(i));
+      }
+      Serial.printf("budget=%lu\n", (unsigned long)Log.flashBudget());
+      return;
+    }
+    int sp = arg.indexOf(' ');
+    String name = (sp < 0) ? arg : arg.substring(0, sp);
+    String rest = (sp < 0) ? String() : arg.substring(sp + 1);
+    rest.trim();
+    int ch = Log.channel(name.c_str());
+    ClogFS::Severity s;
+    if (ch < 0) {
+      Serial.printf("log ch: canal '%s' desconocido\n", name.c_str());
+    } else if (rest.startsWith("quota ")) {
+      long kb = rest.substring(6).toInt();
+      if (kb < 0) kb = 0;
+      Log.setChannelQuota((uint8_t)ch, (uint32_t)kb * 1024);
+      Serial.printf("log ch %s quota=%lu max=%lu\n", name.c_str(),
+                    (unsigned long)Log.channelQuota(ch), (unsigned long)Log.channelMaxFile(ch));
+    } else if (ClogFS::sevFromName(rest.c_str(), &s)) {
+      Log.setChannelMinSeverity((uint8_t)ch, s);
+      Serial.printf("log ch %s level=%s\n", name.c_str(), ClogFS::sevName(s));
+    } else {
+      Serial.println(F("uso: log ch [nombre [TRACE..CRIT|quota KB]]"));
+    }
+
+  } else if (line.startsWith("log budget")) {
+    String arg = line.substring(String("log budget").length());
+    arg.trim();
+    if (arg.length() > 0) {
+      long kb = arg.toInt();
+      Log.setFlashBudget(kb > 0 ? (uint32_t)kb * 1024 : 0);
+    }
+    Serial.printf("log budget = %lu B\n", (unsigned long)Log.flashBudget());
+
   } else if (line.startsWith("out mode")) {
     String arg = line.substring(String("out mode").length());
     arg.trim();
@@ -227,6 +389,10 @@ static void handleSerialCommands(){
       "cmd: use 'cfg on', 'cfg off', 'fs', 'format',\n"
       "     'rot try', 'rot +1d', 'rot reset',\n"
       "     'log lowwater <bytes>', 'log burst N [size]',\n"
+      "     'log stage [KB|off]', 'log sample [every N|ms T|off]',\n"
+      "     'log shed [t d i]', 'log format [text|json] [serial|file]',\n"
+      "     'log ch [nombre [nivel|quota KB]]', 'log budget [KB]',\n"
+      "     'ts',\n"
       "     'fs stats', 'log level [nivel]',\n"
       "     'out mode [off|serial|log|fs|serial+log]'\n"
     ));
@@ -246,15 +412,32 @@ void setup(){
   Log.setFsLowWater(2048);
   Log.setMinSeverity(ClogFS::INFO);  // default: INFO+
   Log.setLevel(ClogFS::LVL_SERIAL_AND_LOG);
+  Log.setRecentCacheBytes(8192);     // /fs/recent
+  //Log.sampleInterval(Msg::BME280_LINE(), 60000);  // p.ej.: 1 línea/min
+  Log.setMsgNameResolver(Msg::nameOf);  // id/nombre en salida JSON
+  // canales: archivos propios, misma tarea de escritura y mismo presupuesto
+  g_ch_sensors = Log.addChannel("sensors", ClogFS::DEBUG, 64 * 1024);  // heartbeats
+  g_ch_audit   = Log.addChannel("audit",   ClogFS::INFO);              // cfg / format
+  if (g_ch_sensors < 0) g_ch_sensors = 0;
+  if (g_ch_audit   < 0) g_ch_audit   = 0;
+  Log.setFlashBudget(512 * 1024);
+  logWeb.setLogger(&Log);
+
+  Ts.setTimeProvider(rtc_now_provider);   // sin hora válida no registra
+  g_ts_heap = Ts.addChannel("heap", 0.1f);  // KB
+  g_ts_rssi = Ts.addChannel("rssi", 1.0f);  // dBm
+  logWeb.setTimeSeries(&Ts);
 
   Log.info(Msg::APP_START(), FW_VERSION);
   st = ST_INIT_FS;
 }
 
 void loop(){
+  Log.loop();
+  Ts.loop();
+  logWeb.loop();   // /fs/recent y /ts siempre; /fs* sólo en modo CFG
 
   if (logWeb.inWebMode()) {
-    logWeb.loop();
     handleSerialCommands();
     return;
   }
@@ -269,6 +452,8 @@ void loop(){
         break;
       }
       Log.info(Msg::FS_MOUNT_OK());
+      Log.mountManifest();
+      Ts.begin();
       Log.listDir("/");
       st = ST_WAIT_WIFI;
       break;
@@ -302,7 +487,7 @@ void loop(){
       if(Rtc.isSynced()){
         Log.info(Msg::NTP_SYNC_OK());
         time_t now = Rtc.now();
-        String fname = ClogFS::makeFilename(now);
+        String fname = ClogFS::makeFilename(now, Log.fileExt());
         String header = String("VERSION=") + FW_VERSION +
                         " MOTIVO_RESET=WDT? IP=" + WiFi.localIP().toString();
         if(Log.openFile(fname.c_str(), header.c_str())){
@@ -335,10 +520,13 @@ void loop(){
         t_last = millis();
         hb_seq++;
 
-        Log.debug(F("hb.debug seq=%lu"), hb_seq);
-        Log.info (F("hb.info seq=%lu"),  hb_seq);
-        Log.warn (F("hb.warn seq=%lu"),  hb_seq);
-        Log.error(F("hb.error seq=%lu"), hb_seq);
+        Log.log(g_ch_sensors, ClogFS::DEBUG, F("hb.debug seq=%lu"), hb_seq);
+        Log.log(g_ch_sensors, ClogFS::INFO,  F("hb.info seq=%lu"),  hb_seq);
+        Log.log(g_ch_sensors, ClogFS::WARN,  F("hb.warn seq=%lu"),  hb_seq);
+        Log.log(g_ch_sensors, ClogFS::ERROR, F("hb.error seq=%lu"), hb_seq);
+
+        Ts.record(g_ts_heap, ESP.getFreeHeap() / 1024.0f);
+        Ts.record(g_ts_rssi, WiFi.RSSI());
       }
       // ========================================
 
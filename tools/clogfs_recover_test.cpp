@@ -0,0 +1,175 @@
+// clogfs_recover_test.cpp — inyección de fallas para ClogFS::recoverTail (host).
+//
+// Arma archivos enmarcados (texto y JSONL) de 16 KB a 16 MB con el ClogFS
+// real sobre un FS de stdio (tools/hoststub), les rompe la cola como lo
+// haría un corte de energía y mide cuánto tarda recoverTail en sanearlos:
+//   torn    líneas enteras sin trailer + una línea cortada
+//   erased  línea cortada + 0xFF (página de flash borrada sin escribir)
+//   badcrc  el último bloque cerrado no verifica su CRC + líneas abiertas
+//   clean   otra pasada sobre el archivo ya reparado (costo de cada mount)
+// Después de cada caso todos los trailers del archivo deben verificar y el
+// archivo debe terminar en uno; el tiempo no debería crecer con el tamaño.
+//
+// Build (desde la raíz del sketch):
+//   g++ -std=gnu++17 -O2 -Itools/hoststub -I. -o clogfs_recover_test tools/clogfs_recover_test.cpp ClogFS.cpp
+//
+// Uso:
+//   clogfs_recover_test [--max MB] [dir]      (default: 16 MB, /tmp/clogfs_recover)
+// Sale con 1 si algún caso no queda como se espera.
+
+#include "ClogFS.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+std::string    g_root = "/tmp/clogfs_recover";   // lo usa tools/hoststub/FS.h
+HardwareSerial Serial;
+LittleFSFS     LittleFS;
+
+static int g_fail = 0;
+
+static time_t fixedNow(){ return 1757800000; }   // 2025-09-13
+
+static void fail(const char* what, const char* fn){
+  fprintf(stderr, "FALLA %s: %s\n", fn, what);
+  g_fail++;
+}
+
+static std::string slurp(const std::string& p){
+  std::string s;
+  if (FILE* f = fopen(p.c_str(), "rb")) {
+    char b[65536];
+    for (size_t n; (n = fread(b, 1, sizeof(b), f)) > 0; ) s.append(b, n);
+    fclose(f);
+  }
+  return s;
+}
+
+static void appendRaw(const std::string& p, const std::string& s){
+  if (FILE* f = fopen(p.c_str(), "ab")) { fwrite(s.data(), 1, s.size(), f); fclose(f); }
+}
+
+static size_t fileSize(const std::string& p){
+  struct stat st;
+  return stat(p.c_str(), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+// trailers del archivo: inicio de la línea y si el CRC verifica
+struct Trailer { size_t start, end; bool ok; };
+
+static std::vector<Trailer> trailers(const std::string& s){
+  std::vector<Trailer> v;
+  for (size_t ls = 0, nl; ls < s.size() && (nl = s.find('\n', ls)) != std::string::npos; ls = nl + 1) {
+    uint32_t seq, len, crc;
+    if (!ClogFS::parseFrameTrailer(s.data() + ls, nl - ls, &seq, &len, &crc)) continue;
+    bool ok = len <= ls && ClogFS::crc32(0, s.data() + ls - len, len) == crc;
+    v.push_back({ ls, nl + 1, ok });
+  }
+  return v;
+}
+
+// invariante tras recoverTail: todo trailer verifica y cierra el archivo
+static bool sane(const std::string& full){
+  std::string s = slurp(full);
+  std::vector<Trailer> t = trailers(s);
+  for (const Trailer& x : t) if (!x.ok) return false;
+  return !t.empty() && t.back().end == s.size();
+}
+
+static void build(const char* fn, size_t target, bool jsonl){
+  std::string full = g_root + fn;
+  remove(full.c_str());
+  ClogFS L;
+  L.setMountPoint(g_root.c_str());
+  L.setTimeProvider(fixedNow);
+  L.setLevel(ClogFS::LVL_LOG_ONLY);
+  L.setFileFormat(jsonl ? ClogFS::FMT_JSONL : ClogFS::FMT_TEXT);
+  L.setFraming(true);
+  L.openFile(fn, "VERSION=host MOTIVO_RESET=test");
+  for (int i = 0; ; ++i) {
+    L.info(F("line %d value=%d some padding text here"), i, i * 7);
+    if ((i & 255) == 0 && fileSize(full) >= target) break;
+  }
+  L.closeFile();
+}
+
+static std::string openLines(bool jsonl, int n){
+  std::string s;
+  char line[96];
+  for (int k = 0; k < n; ++k) {
+    if (jsonl) snprintf(line, sizeof(line), "{\"t\":1757800000,\"sev\":\"INFO\",\"msg\":\"tail %d\"}\r\n", k);
+    else       snprintf(line, sizeof(line), "INFO 2025-09-13 22:53:20 tail %d\r\n", k);
+    s += line;
+  }
+  return s;
+}
+
+static const std::string CUT = "INFO 2025-09-13 22:53:20 line 9999 val";
+
+int main(int argc, char** argv){
+  size_t maxBytes = 16u << 20;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--max") && i + 1 < argc) maxBytes = (size_t)atol(argv[++i]) << 20;
+    else g_root = argv[i];
+  }
+  while (g_root.size() > 1 && g_root.back() == '/') g_root.pop_back();
+  mkdir(g_root.c_str(), 0755);
+
+  printf("formato     tamaño |   torn us  erased us  badcrc us   clean us | scanned(clean)\n");
+  for (int jsonl = 0; jsonl < 2; ++jsonl)
+  for (size_t target = 16u << 10; target <= maxBytes; target *= 4) {
+    char fn[40];
+    snprintf(fn, sizeof(fn), "/rt-%zu%s", target, jsonl ? ".jsonl" : ".txt");
+    std::string full = g_root + fn;
+    build(fn, target, jsonl);
+    size_t size = fileSize(full);
+    if (!sane(full)) fail("el archivo generado no verifica", fn);
+
+    ClogFS R;
+    R.setMountPoint(g_root.c_str());
+    R.setLevel(ClogFS::LVL_OFF);
+    R.setFraming(true);
+    ClogFS::RecoverInfo torn, erased, bad, clean;
+
+    // 1) líneas sanas sin cerrar + una cortada: se conservan y re-enmarcan
+    appendRaw(full, openLines(jsonl, 20) + CUT);
+    if (!R.recoverTail(fn, &torn) || !torn.kept || torn.dropped != CUT.size() || !sane(full))
+      fail("torn", fn);
+
+    // 2) línea cortada + flash borrada: se trunca al último trailer
+    appendRaw(full, CUT + std::string(300, '\xff'));
+    if (!R.recoverTail(fn, &erased) || !erased.framed || erased.kept ||
+        erased.dropped != CUT.size() + 300 || !sane(full))
+      fail("erased", fn);
+
+    // 3) un byte dañado en el último bloque cerrado: el bloque se descarta
+    //    y las líneas abiertas de después se re-enmarcan tras la marca
+    {
+      std::string s = slurp(full);
+      std::vector<Trailer> t = trailers(s);
+      if (t.size() < 2) { fail("sin bloques para dañar", fn); continue; }
+      size_t at = t.back().start - 10;
+      s[at] = (s[at] == 'a') ? 'b' : 'a';
+      s += openLines(jsonl, 2);
+      if (FILE* f = fopen(full.c_str(), "wb")) { fwrite(s.data(), 1, s.size(), f); fclose(f); }
+    }
+    if (!R.recoverTail(fn, &bad) || bad.framed || bad.badFrames != 1 || !bad.kept || !sane(full) ||
+        slurp(full).find(jsonl ? "{\"#X\":\"dropped=" : "#X dropped=") == std::string::npos)
+      fail("badcrc", fn);
+
+    // 4) ya sano: nada que tocar, una ventana de lectura
+    if (!R.recoverTail(fn, &clean) || !clean.framed || clean.kept || clean.dropped || clean.badFrames)
+      fail("clean", fn);
+
+    printf("%-6s %11zu | %9lu %10lu %10lu %10lu | %lu\n", jsonl ? "jsonl" : "text", size,
+           (unsigned long)torn.micros, (unsigned long)erased.micros,
+           (unsigned long)bad.micros, (unsigned long)clean.micros, (unsigned long)clean.scanned);
+    fflush(stdout);
+    remove(full.c_str());
+  }
+  if (g_fail) fprintf(stderr, "%d caso(s) fallaron\n", g_fail);
+  return g_fail ? 1 : 0;
+}
@@ -0,0 +1,117 @@
+// Arduino.h — stub mínimo para compilar ClogFS en el host (Linux), sólo
+// para las herramientas de tools/. No es un core: cubre lo que usa ClogFS
+// sin ARDUINO_ARCH_ESP32 (sin FreeRTOS, CRC por software).
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <strings.h>
+
+class __FlashStringHelper;
+#define F(s)            (reinterpret_cast<const __FlashStringHelper*>(s))
+#define PSTR(s)         (s)
+#define vsnprintf_P     vsnprintf
+#define snprintf_P      snprintf
+#define strlen_P        strlen
+#define strncpy_P       strncpy
+#define memcpy_P        memcpy
+#define strcmp_P        strcmp
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define IRAM_ATTR
+typedef const char* PGM_P;
+
+// como en el ESP32: 32 bits que dan la vuelta
+inline unsigned long millis(){
+  using namespace std::chrono;
+  return (uint32_t)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+inline unsigned long micros(){
+  using namespace std::chrono;
+  return (uint32_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+inline void delay(unsigned long){}
+inline void yield(){}
+inline bool  psramFound(){ return false; }
+inline void* ps_malloc(size_t n){ return malloc(n); }
+
+class String {
+public:
+  std::string s;
+  String(){}
+  String(const char* c){ if (c) s = c; }
+  explicit String(const std::string& x) : s(x) {}
+  String(const __FlashStringHelper* f) : s((const char*)f) {}
+  String(char c) : s(1, c) {}
+  String(int v)           : s(std::to_string(v)) {}
+  String(unsigned v)      : s(std::to_string(v)) {}
+  String(long v)          : s(std::to_string(v)) {}
+  String(unsigned long v) : s(std::to_string(v)) {}
+
+  const char* c_str() const  { return s.c_str(); }
+  unsigned    length() const { return s.size(); }
+  bool        isEmpty() const { return s.empty(); }
+  bool reserve(unsigned n){ s.reserve(n); return true; }
+  bool startsWith(const String& p) const { return s.rfind(p.s, 0) == 0; }
+  bool endsWith(const String& p) const {
+    return s.size() >= p.s.size() && s.compare(s.size() - p.s.size(), p.s.size(), p.s) == 0;
+  }
+  int indexOf(char c, unsigned from = 0) const { auto r = s.find(c, from); return r == std::string::npos ? -1 : (int)r; }
+  int lastIndexOf(char c) const { auto r = s.rfind(c); return r == std::string::npos ? -1 : (int)r; }
+  String substring(unsigned a) const { return a < s.size() ? String(s.substr(a)) : String(); }
+  String substring(unsigned a, unsigned b) const { return a < s.size() ? String(s.substr(a, b - a)) : String(); }
+  void remove(unsigned i){ s.erase(i); }
+  void remove(unsigned i, unsigned n){ s.erase(i, n); }
+  long toInt() const { return atol(s.c_str()); }
+  bool equalsIgnoreCase(const String& o) const { return strcasecmp(s.c_str(), o.c_str()) == 0; }
+  bool operator==(const String& o) const { return s == o.s; }
+  bool operator==(const char* o) const   { return s == o; }
+  bool operator!=(const String& o) const { return s != o.s; }
+  char  operator[](unsigned i) const { return s[i]; }
+  char& operator[](unsigned i)       { return s[i]; }
+  String& operator+=(const String& o){ s += o.s; return *this; }
+  String& operator+=(const char* o)  { s += o; return *this; }
+  String& operator+=(char c)         { s += c; return *this; }
+  String& operator+=(int v)          { s += std::to_string(v); return *this; }
+  String& operator+=(unsigned v)     { s += std::to_string(v); return *this; }
+  String& operator+=(long v)         { s += std::to_string(v); return *this; }
+  String& operator+=(unsigned long v){ s += std::to_string(v); return *this; }
+  String& operator+=(const __FlashStringHelper* f){ s += (const char*)f; return *this; }
+  bool concat(const char* p, unsigned n){ s.append(p, n); return true; }
+  bool concat(const char* c)   { s += c; return true; }
+  bool concat(const String& o) { s += o.s; return true; }
+  bool concat(char c)          { s += c; return true; }
+  bool concat(int v)           { s += std::to_string(v); return true; }
+  bool concat(unsigned v)      { s += std::to_string(v); return true; }
+  bool concat(long v)          { s += std::to_string(v); return true; }
+  bool concat(unsigned long v) { s += std::to_string(v); return true; }
+};
+template <class T> String operator+(const String& a, const T& b){ String r = a; r += b; return r; }
+inline String operator+(const char* a, const String& b){ String r(a); r += b; return r; }
+
+// Serial a stdout sólo si el harness lo pide (nivel LVL_SERIAL*)
+class Print {
+public:
+  virtual ~Print(){}
+  virtual size_t write(uint8_t c){ return fwrite(&c, 1, 1, stdout); }
+  virtual size_t write(const uint8_t* b, size_t n){ return fwrite(b, 1, n, stdout); }
+  size_t write(const char* p, size_t n){ return write((const uint8_t*)p, n); }
+  size_t print(const char* s)   { return write((const uint8_t*)s, strlen(s)); }
+  size_t print(const String& s) { return print(s.c_str()); }
+  size_t print(char c)          { return write((uint8_t)c); }
+  size_t println(const char* s = ""){ return print(s) + print("\r\n"); }
+  size_t println(const String& s)   { return println(s.c_str()); }
+  void flush(){}
+};
+class Stream : public Print {
+public:
+  int available(){ return 0; }
+  int read(){ return -1; }
+};
+class HardwareSerial : public Stream { public: void begin(unsigned long){} };
+extern HardwareSerial Serial;
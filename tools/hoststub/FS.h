@@ -0,0 +1,110 @@
+// FS.h — stub de host: fs::FS / fs::File sobre stdio. Las rutas del sketch
+// ("/log.txt") se resuelven bajo g_root, que define el programa; ClogFS
+// debe usar el mismo directorio como punto de montaje (setMountPoint) para
+// que truncate() caiga en el archivo real.
+#pragma once
+#include "Arduino.h"
+#include <dirent.h>
+#include <memory>
+#include <sys/stat.h>
+#include <vector>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+extern std::string g_root;
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+struct FileImpl {
+  FILE*       f = nullptr;
+  std::string path;
+  bool        dir = false;
+  std::vector<std::string> ents;
+  size_t      idx = 0;
+  ~FileImpl(){ if (f) fclose(f); }
+};
+
+class File : public Stream {
+public:
+  std::shared_ptr<FileImpl> p;
+
+  operator bool() const { return (bool)p; }
+  size_t size() const {
+    if (!p || p->dir) return 0;
+    if (p->f) fflush(p->f);
+    struct stat st;
+    return stat((g_root + p->path).c_str(), &st) == 0 ? (size_t)st.st_size : 0;
+  }
+  bool seek(uint32_t pos, SeekMode m = SeekSet){
+    return p && p->f && fseek(p->f, pos, m == SeekSet ? SEEK_SET : m == SeekCur ? SEEK_CUR : SEEK_END) == 0;
+  }
+  size_t position() const { return p && p->f ? (size_t)ftell(p->f) : 0; }
+  int    read(){ return p && p->f ? fgetc(p->f) : -1; }
+  size_t read(uint8_t* b, size_t n){ return p && p->f ? fread(b, 1, n, p->f) : 0; }
+  size_t write(const uint8_t* b, size_t n) override { return p && p->f ? fwrite(b, 1, n, p->f) : 0; }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t print(const char* s)   { return write((const uint8_t*)s, strlen(s)); }
+  size_t print(const String& s) { return print(s.c_str()); }
+  size_t println(const char* s = ""){ return print(s) + print("\r\n"); }
+  size_t println(const String& s)   { return println(s.c_str()); }
+  void   flush(){ if (p && p->f) fflush(p->f); }
+  void   close(){ p.reset(); }
+  const char* name() const { return p->path.c_str() + p->path.rfind('/') + 1; }
+  const char* path() const { return p->path.c_str(); }
+  bool   isDirectory(){ return p && p->dir; }
+  time_t getLastWrite(){ struct stat st; return stat((g_root + p->path).c_str(), &st) == 0 ? st.st_mtime : 0; }
+  File   openNextFile(const char* mode = FILE_READ);
+};
+
+class FS {
+public:
+  File open(const char* path, const char* mode = FILE_READ, bool = false){
+    File r;
+    std::string full = g_root + path;
+    struct stat st;
+    if (stat(full.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+      auto i = std::make_shared<FileImpl>();
+      i->dir = true; i->path = path;
+      if (DIR* d = opendir(full.c_str())) {
+        for (dirent* e; (e = readdir(d)); ) {
+          if (strcmp(e->d_name, ".") && strcmp(e->d_name, "..")) i->ents.push_back(e->d_name);
+        }
+        closedir(d);
+      }
+      std::sort(i->ents.begin(), i->ents.end());
+      r.p = i;
+      return r;
+    }
+    FILE* f = fopen(full.c_str(), mode[0] == 'r' ? "rb" : mode[0] == 'w' ? "wb" : "ab");
+    if (!f) return r;
+    auto i = std::make_shared<FileImpl>();
+    i->f = f; i->path = path;
+    r.p = i;
+    return r;
+  }
+  File open(const String& p, const char* m = FILE_READ, bool c = false){ return open(p.c_str(), m, c); }
+  bool exists(const char* p){ struct stat st; return stat((g_root + p).c_str(), &st) == 0; }
+  bool exists(const String& p){ return exists(p.c_str()); }
+  bool remove(const char* p){ return ::remove((g_root + p).c_str()) == 0; }
+  bool remove(const String& p){ return remove(p.c_str()); }
+  bool rename(const char* a, const char* b){ return ::rename((g_root + a).c_str(), (g_root + b).c_str()) == 0; }
+  bool rename(const String& a, const String& b){ return rename(a.c_str(), b.c_str()); }
+  bool mkdir(const char* p){ return ::mkdir((g_root + p).c_str(), 0755) == 0; }
+  bool mkdir(const String& p){ return mkdir(p.c_str()); }
+};
+
+inline File File::openNextFile(const char*){
+  if (!p || !p->dir || p->idx >= p->ents.size()) return File();
+  std::string base = p->path;
+  if (base.empty() || base.back() != '/') base += '/';
+  return FS().open((base + p->ents[p->idx++]).c_str());
+}
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
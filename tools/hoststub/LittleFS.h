@@ -0,0 +1,12 @@
+// LittleFS.h — stub de host: el FS de FS.h con begin()/totalBytes() fijos.
+#pragma once
+#include "FS.h"
+
+class LittleFSFS : public fs::FS {
+public:
+  bool   begin(bool = false, const char* = "/littlefs", uint8_t = 10, const char* = "spiffs"){ return true; }
+  bool   format(){ return true; }
+  size_t totalBytes(){ return 16u << 20; }
+  size_t usedBytes(){ return 0; }
+};
+extern LittleFSFS LittleFS;